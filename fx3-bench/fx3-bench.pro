@@ -0,0 +1,12 @@
+TEMPLATE = app
+CONFIG += console c++2a
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Coroutines need an explicit switch before GCC 11
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+SOURCES += \
+        main.cpp
+
+include(../libfx3link/libfx3link.pri)
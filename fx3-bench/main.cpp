@@ -0,0 +1,1088 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <fx3link.h>
+
+using namespace fx3link;
+using Clock = std::chrono::steady_clock;
+
+static void usage()
+{
+    printf("Usage: fx3-bench <command> [options]\n");
+    printf("  loopback [seconds] [transfer size] [queue depth] [flush us] [credit]\n");
+    printf("                                                   Bulk EP1 OUT -> EP1 IN throughput\n");
+    printf("  ep0 [iterations]                                 Vendor request round trip latency\n");
+    printf("  ep0pipe [iterations] [concurrency]               Pipelined vendor requests (coroutines)\n");
+    printf("  ep0rt [iterations] [cpu] [priority] [lock]       Vendor request latency, blocking vs busy-poll events\n");
+    printf("  cbtime [iterations]                              Device side USB callback execution time\n");
+    printf("  boot                                             Device boot timeline\n");
+    printf("  log [seconds]                                    Drain and print the binary log, then follow it\n");
+    printf("  profile [seconds] [rate] [file]                  Sample the device CPU, PCs to file for fx3profile.py\n");
+    printf("  events [seconds]                                 Print the device events from the interrupt endpoint\n");
+    printf("  latency [seconds]                                Device EP0 and DMA buffer latency histograms\n");
+    printf("  threads [seconds]                                Device CPU load and stack use per thread\n");
+    printf("  clock [seconds]                                  Fit the device clock against the host clock\n");
+    printf("  stamped [seconds] [crc]                          Loopback with buffer headers, device to host delay\n");
+    printf("  compress [seconds] [rle|delta|both]              Loopback with device compression, host decoding\n");
+    printf("  verify [seconds] [counter|prbs|constant]         Loopback of a test pattern, every IN byte checked\n");
+    printf("  pipeline [seconds] [workers] [first cpu]         Loopback checked by a multi-threaded pipeline\n");
+    printf("  crc [MB]                                         Host and device CRC-32C throughput\n");
+    printf("  stats                                            Firmware diagnostic counters\n");
+}
+
+struct StreamRun {
+    int error = LIBUSB_SUCCESS;
+    double elapsed = 0;     // Seconds from stream start to drained
+};
+
+// What every streaming bench shares: runs the event loop and the stream
+// until the time is up, then lets the fill handler end the stream and
+// stops both. The device must be configured and the data handler set.
+// idle runs on this thread every 10 ms meanwhile, an error from it ends
+// the run.
+static StreamRun runTimedStream(Context &ctx, Stream &stream, double seconds, Stream::FillHandler fill,
+                                const std::function<int()> &idle = nullptr)
+{
+    const auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    std::atomic<bool> expired{false};
+    stream.onFill([&expired, &fill](uint8_t *data, size_t size, uint32_t sequence) -> size_t {
+        return expired.load(std::memory_order_relaxed) ? 0 : fill(data, size, sequence);
+    });
+
+    StreamRun run;
+    EventLoop loop(ctx);
+    run.error = loop.start();
+    const auto start = Clock::now();
+    if (run.error == LIBUSB_SUCCESS)
+        run.error = stream.start();
+    while ((run.error == LIBUSB_SUCCESS) && stream.isRunning() && (Clock::now() - start < duration)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (idle)
+            run.error = idle();
+    }
+    expired = true;
+    if (run.error == LIBUSB_SUCCESS)
+        run.error = stream.wait();
+    run.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    stream.stop();
+    loop.stop();
+    return run;
+}
+
+static int benchLoopback(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    StreamOptions options = StreamOptions::forSpeed(device.speed());
+    if (argc > 1)
+        options.transferSize = strtoul(argv[1], nullptr, 0);
+    if (argc > 2)
+        options.queueDepth = strtoul(argv[2], nullptr, 0);
+    StreamConfig config;
+    if (argc > 3)
+        config.flushTimeoutUs = static_cast<uint16_t>(strtoul(argv[3], nullptr, 0));
+    if ((argc > 4) && atoi(argv[4])) {
+        config.flags |= StreamFlagCredit;
+        options.creditFlow = true;
+    }
+
+    std::atomic<uint32_t> overruns{0};
+
+    Stream stream(device);
+    EventListener listener(device);
+    stream.setOptions(options);
+    listener.onEvent([&stream, &overruns](const DeviceEvent &event) {
+        if (event.type == DeviceEvent::Overrun)
+            overruns.fetch_add(event.arg0, std::memory_order_relaxed);
+        stream.updateCredit(event);
+    });
+
+    // The listener is submitted first, so the stream sees the channel restart
+    int err = listener.start();
+    if (err == LIBUSB_SUCCESS)
+        err = device.setStreamConfig(config);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    const StreamRun run = runTimedStream(ctx, stream, seconds, [](uint8_t *, size_t size, uint32_t) { return size; });
+    listener.stop();
+    if (run.error != LIBUSB_SUCCESS) {
+        printf("FAIL on stream! ( %s )\n", errorName(run.error));
+        return -1;
+    }
+
+    printf("Transfer size  : %zu bytes, queue depth %u\n", options.transferSize, options.queueDepth);
+    printf("OUT            : %.1f MB/s\n", stream.bytesOut() / run.elapsed / 1e6);
+    printf("IN             : %.1f MB/s\n", stream.bytesIn() / run.elapsed / 1e6);
+    StreamStatus status;
+    if (device.getStreamStatus(status) == LIBUSB_SUCCESS) {
+        printf("Device buffers : %u x %u bytes\n", status.bufferCount, status.bufferSize);
+        if (config.flushTimeoutUs)
+            printf("Flush          : %u us, %u partial buffers sent, %llu short IN transfers\n", config.flushTimeoutUs,
+                   status.flushCount, static_cast<unsigned long long>(stream.shortTransfers()));
+    }
+    printf("Device full    : %u times", overruns.load());
+    if (options.creditFlow)
+        printf(", %llu OUT transfers held for credit", static_cast<unsigned long long>(stream.creditWaits()));
+    printf("\n");
+    return 0;
+}
+
+static int benchEp0(Device &device, int argc, char *argv[])
+{
+    const int iterations = (argc > 0) ? std::max(atoi(argv[0]), 1) : 1000;
+    unsigned char buffer[64];
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    memset(buffer, 0x55, sizeof(buffer));
+    for (int i = 0; i < iterations; i++) {
+        const auto start = Clock::now();
+        int err = device.controlOut(VendorRequest, 0, buffer, sizeof(buffer));
+        if (err >= 0)
+            err = device.controlIn(VendorRequest, 0, buffer, sizeof(buffer));
+        if (err < 0) {
+            printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(err));
+            return -1;
+        }
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+
+    std::sort(samples.begin(), samples.end());
+    printf("EP0 OUT+IN round trip, %d iterations\n", iterations);
+    printf("  min %.1f us, median %.1f us, p99 %.1f us, max %.1f us\n",
+           samples.front(), samples[samples.size() / 2],
+           samples[samples.size() * 99 / 100], samples.back());
+    return 0;
+}
+
+// One echo sequence per iteration. The device has a single EP0 buffer, so
+// with several workers in flight only the length of the echo is checked.
+static coro::Task<int> echoWorker(Device &device, int iterations, uint8_t seed)
+{
+    coro::Operation op(device, 64);
+    for (int i = 0; i < iterations; i++) {
+        const uint8_t pattern = static_cast<uint8_t>(seed + i);
+        memset(op.data(), pattern, 64);
+        coro::TransferResult result = co_await op.controlOut(VendorRequest, 0, 64);
+        if (result.error == LIBUSB_SUCCESS)
+            result = co_await op.controlIn(VendorRequest, 0, 64);
+        if (result.error != LIBUSB_SUCCESS)
+            co_return result.error;
+        if (result.actualLength != 64)
+            co_return LIBUSB_ERROR_OVERFLOW;
+    }
+    co_return LIBUSB_SUCCESS;
+}
+
+static int benchEp0Pipelined(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const int iterations = (argc > 0) ? std::max(atoi(argv[0]), 1) : 1000;
+    const int concurrency = (argc > 1) ? std::max(atoi(argv[1]), 1) : 4;
+
+    EventLoop loop(ctx);
+    int err = loop.start();
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on event loop! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    std::vector<coro::Task<int>> workers;
+    for (int i = 0; i < concurrency; i++)
+        workers.push_back(echoWorker(device, iterations / concurrency, static_cast<uint8_t>(i * 0x40)));
+
+    const auto start = Clock::now();
+    const std::vector<int> results = coro::syncWaitAll(workers);
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    loop.stop();
+
+    for (int result : results) {
+        if (result != LIBUSB_SUCCESS) {
+            printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(result));
+            return -1;
+        }
+    }
+
+    const int total = (iterations / concurrency) * concurrency;
+    printf("EP0 OUT+IN pipelined, %d iterations, %d in flight\n", total, concurrency);
+    printf("  %.0f round trips/s, %.1f us each\n", total / elapsed, elapsed * 1e6 / total);
+    return 0;
+}
+
+// Echo round trips timed on the event thread, so the time the thread takes
+// to wake up for each completion is part of every sample
+static coro::Task<int> timedEcho(Device &device, std::vector<double> &samples, int iterations)
+{
+    coro::Operation op(device, 64);
+    memset(op.data(), 0x55, 64);
+    for (int i = 0; i < iterations; i++) {
+        const auto start = Clock::now();
+        coro::TransferResult result = co_await op.controlOut(VendorRequest, 0, 64);
+        if (result.error == LIBUSB_SUCCESS)
+            result = co_await op.controlIn(VendorRequest, 0, 64);
+        if (result.error != LIBUSB_SUCCESS)
+            co_return result.error;
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    co_return LIBUSB_SUCCESS;
+}
+
+// The same echo loop with the default event loop and with a busy-polling,
+// optionally pinned, SCHED_FIFO and memory-locked one
+static int benchEp0Realtime(Context &ctx, Device &device, int argc, char *argv[])
+{
+    constexpr double budgetUs = 200.0;
+    const int iterations = (argc > 0) ? std::max(atoi(argv[0]), 1) : 10000;
+    EventLoopOptions realtime;
+    realtime.busyPoll = true;
+    realtime.cpu = (argc > 1) ? atoi(argv[1]) : -1;
+    realtime.realtimePriority = (argc > 2) ? atoi(argv[2]) : 0;
+    realtime.lockMemory = (argc > 3) && atoi(argv[3]);
+
+    const EventLoopOptions modes[] = { EventLoopOptions(), realtime };
+    const char *names[] = { "blocking", "busy-poll" };
+    for (int m = 0; m < 2; m++) {
+        EventLoop loop(ctx, modes[m]);
+        int err = loop.start();
+        if (err != LIBUSB_SUCCESS) {
+            printf("FAIL on event loop! ( %s )\n", errorName(err));
+            return -1;
+        }
+
+        std::vector<double> samples;
+        samples.reserve(iterations);
+        err = coro::syncWait(timedEcho(device, samples, iterations));
+        loop.stop();
+        if (err != LIBUSB_SUCCESS) {
+            printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(err));
+            return -1;
+        }
+
+        std::sort(samples.begin(), samples.end());
+        const size_t over = samples.end() - std::upper_bound(samples.begin(), samples.end(), budgetUs);
+        printf("%-10s: min %.1f us, median %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us, %zu over %.0f us\n",
+               names[m], samples.front(), samples[samples.size() / 2], samples[samples.size() * 99 / 100],
+               samples[samples.size() * 999 / 1000], samples.back(), over, budgetUs);
+    }
+    return 0;
+}
+
+static double ticksToUs(double ticks)
+{
+    return ticks * 1e6 / TimerHz;
+}
+
+// Runs EP0 echo requests and reports how long the setup callback took on
+// the device for them. Compare builds with CY_FX_TCM_ENABLE 0 and 1.
+static int benchCallbackTime(Device &device, int argc, char *argv[])
+{
+    const int iterations = (argc > 0) ? std::max(atoi(argv[0]), 1) : 1000;
+    unsigned char buffer[64];
+    std::vector<CbTimeStats> before, after;
+
+    int err = device.getStats(StatsPageCbTime, before);
+    memset(buffer, 0x55, sizeof(buffer));
+    for (int i = 0; (i < iterations) && (err >= 0); i++) {
+        err = device.controlOut(VendorRequest, 0, buffer, sizeof(buffer));
+        if (err >= 0)
+            err = device.controlIn(VendorRequest, 0, buffer, sizeof(buffer));
+    }
+    if (err >= 0)
+        err = device.getStats(StatsPageCbTime, after);
+    if (err < 0) {
+        printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    static const char *const names[] = { "setup", "event" };
+    for (size_t i = 0; (i < after.size()) && (i < before.size()); i++) {
+        const CbTimeStats &stats = after[i];
+        const uint32_t calls = stats.count - before[i].count;
+        const uint64_t ticks = stats.totalTicks() - before[i].totalTicks();
+        printf("%-5s callback : %s, %u calls, avg %.2f us (since boot: min %.2f us, max %.2f us)\n",
+               (stats.id < 2) ? names[stats.id] : "?", (stats.flags & 1) ? "I-TCM" : "system RAM", calls,
+               calls ? ticksToUs(double(ticks) / calls) : 0.0, ticksToUs(stats.minTicks), ticksToUs(stats.maxTicks));
+    }
+    return 0;
+}
+
+// Stage names in CyFxTimelineStage_t order
+static const char *const bootStages[] = {
+    "main", "device init", "IO matrix", "GPIO init", "USB init", "connect",
+    "debug init", "first setup", "app start",
+};
+
+static int showBootTimeline(Device &device)
+{
+    std::vector<TimelineMark> marks;
+    int err = device.getStats(StatsPageTimeline, marks);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    printf("Boot stage      time (ms)   step (ms)\n");
+    double previous = 0.0;
+    for (const TimelineMark &mark : marks) {
+        const char *name = (mark.stage < sizeof(bootStages) / sizeof(bootStages[0])) ? bootStages[mark.stage] : "?";
+        if (!(mark.flags & TimelineMark::Reached)) {
+            printf("%-14s  not reached\n", name);
+        } else if (!(mark.flags & TimelineMark::Timed)) {
+            printf("%-14s  before the counter\n", name);
+        } else {
+            const double ms = ticksToUs(mark.ticks) / 1000.0;
+            printf("%-14s  %9.3f   %9.3f\n", name, ms, ms - previous);
+            previous = ms;
+        }
+    }
+    return 0;
+}
+
+static int showLog(Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 0.0;
+    const auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    const auto start = Clock::now();
+    LogDecoder decoder;
+    std::vector<LogRecord> records;
+
+    do {
+        uint32_t lost = 0;
+        records.clear();
+        int err = device.readLog(records, lost);
+        if (err != LIBUSB_SUCCESS) {
+            printf("FAIL on log request! ( %s )\n", errorName(err));
+            return -1;
+        }
+        if (lost)
+            printf("--- %u records lost ---\n", lost);
+        for (const LogRecord &record : records)
+            printf("%s\n", decoder.render(record).c_str());
+        if (records.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    } while (!records.empty() || (Clock::now() - start < duration));
+    return 0;
+}
+
+static int runProfile(Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    const uint16_t rate = (argc > 1) ? static_cast<uint16_t>(strtoul(argv[1], nullptr, 0)) : 1000;
+    const char *fileName = (argc > 2) ? argv[2] : "fx3profile.txt";
+
+    int err = device.startProfile(rate);
+    if (err == LIBUSB_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        err = device.startProfile(0);
+    }
+    ProfileSummary summary;
+    std::vector<ProfileThread> threads;
+    std::vector<ProfilePc> pcs;
+    if (err == LIBUSB_SUCCESS)
+        err = device.readProfile(summary, threads, pcs);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on profile request! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    const double total = summary.samples ? summary.samples : 1;
+    printf("Samples        : %u at %u Hz, idle %.1f %%, missed %u, no PC %u, PC table overflow %u\n",
+           summary.samples, rate, summary.idle * 100.0 / total, summary.missed, summary.unknownPc, summary.pcOverflow);
+    std::sort(threads.begin(), threads.end(),
+              [](const ProfileThread &a, const ProfileThread &b) { return a.count > b.count; });
+    for (const ProfileThread &thread : threads) {
+        printf("  %-20.*s %6.1f %%\n", static_cast<int>(sizeof(thread.name)), thread.name,
+               thread.count * 100.0 / total);
+    }
+
+    FILE *file = fopen(fileName, "w");
+    if (!file) {
+        printf("FAIL on '%s'!\n", fileName);
+        return -1;
+    }
+    for (const ProfilePc &pc : pcs)
+        fprintf(file, "0x%08X %u\n", pc.pc, pc.count);
+    fclose(file);
+    printf("%zu program counters written to %s, symbolize with tools/fx3profile.py\n", pcs.size(), fileName);
+    return 0;
+}
+
+static void printEvent(const DeviceEvent &event)
+{
+    static const char *const counters[] = { "worker queue drops", "heap corruptions", "bulk overruns", "OUT CRC errors" };
+    printf("%10.3f ms  #%-5u ", ticksToUs(event.ticks) / 1000.0, event.seq);
+    switch (event.type) {
+    case DeviceEvent::StreamStart:
+        printf("stream started, %u buffers, USB speed %u\n", event.arg0, event.arg1);
+        break;
+    case DeviceEvent::StreamStop:
+        printf("stream stopped\n");
+        break;
+    case DeviceEvent::Overrun:
+        printf("bulk overrun x%u, all %u buffers full\n", event.arg0, event.arg1);
+        break;
+    case DeviceEvent::DmaError:
+        printf("bulk DMA error\n");
+        break;
+    case DeviceEvent::Counter:
+        printf("%s reached %u\n", (event.arg0 < 4) ? counters[event.arg0] : "?", event.arg1);
+        break;
+    default:
+        printf("event %u (0x%08X, 0x%08X)\n", event.type, event.arg0, event.arg1);
+        break;
+    }
+}
+
+static int showEvents(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 10.0;
+    EventLoop loop(ctx);
+    EventListener listener(device);
+    listener.onEvent(printEvent);
+
+    int err = loop.start();
+    if (err == LIBUSB_SUCCESS)
+        err = listener.start();
+    if (err == LIBUSB_SUCCESS) {
+        const auto start = Clock::now();
+        const auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        while (listener.isRunning() && (Clock::now() - start < duration))
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        err = listener.error();
+    }
+    listener.stop();
+    loop.stop();
+
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on event endpoint! ( %s )\n", errorName(err));
+        return -1;
+    }
+    if (listener.lost())
+        printf("%u events lost\n", listener.lost());
+    return 0;
+}
+
+// Upper bound of the bucket that holds the given fraction of the samples
+static double latencyPercentile(const LatencyHist &histogram, double fraction)
+{
+    uint64_t seen = 0;
+    for (size_t i = 0; i < LatencyBuckets; i++) {
+        seen += histogram.buckets[i];
+        if (seen >= fraction * histogram.count)
+            return (i + 1 < LatencyBuckets) ? ticksToUs(double(uint64_t(2) << i)) : ticksToUs(histogram.maxTicks);
+    }
+    return ticksToUs(histogram.maxTicks);
+}
+
+// Clears the device histograms, lets the device run (e.g. alongside a
+// loopback run) and prints what was collected
+static int showLatency(Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    std::vector<LatencyHist> histograms;
+
+    int err = device.resetLatency();
+    if (err == LIBUSB_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        err = device.readLatency(histograms);
+    }
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on latency request! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    static const char *const names[] = { "EP0 setup", "DMA buffer" };
+    for (const LatencyHist &histogram : histograms) {
+        printf("%s : %u samples, p50 < %.2f us, p99 < %.2f us, p99.9 < %.2f us, max %.2f us\n",
+               (histogram.id < 2) ? names[histogram.id] : "?", histogram.count,
+               latencyPercentile(histogram, 0.5), latencyPercentile(histogram, 0.99),
+               latencyPercentile(histogram, 0.999), ticksToUs(histogram.maxTicks));
+        for (size_t i = 0; i < LatencyBuckets; i++) {
+            if (!histogram.buckets[i])
+                continue;
+            const double low = i ? ticksToUs(double(uint64_t(1) << i)) : 0.0;
+            if (i + 1 < LatencyBuckets)
+                printf("  %10.2f .. %10.2f us  %u\n", low, ticksToUs(double(uint64_t(2) << i)), histogram.buckets[i]);
+            else
+                printf("  %10.2f us and above   %u\n", low, histogram.buckets[i]);
+        }
+    }
+    return 0;
+}
+
+static int showThreads(Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 1.0;
+    std::vector<ThreadStats> before, after;
+
+    int err = device.getStats(StatsPageThreads, before);
+    if (err == LIBUSB_SUCCESS) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        err = device.getStats(StatsPageThreads, after);
+    }
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    // Rows only grow and keep their order, so row i is the same thread in both reads
+    std::vector<uint32_t> runTime(after.size());
+    uint64_t total = 0;
+    for (size_t i = 0; i < after.size(); i++) {
+        const bool idle = (i + 1 == after.size());
+        const ThreadStats *previous = nullptr;
+        if (idle && !before.empty())
+            previous = &before.back();
+        else if (!idle && (i + 1 < before.size()))
+            previous = &before[i];
+        runTime[i] = after[i].runTimeUs - (previous ? previous->runTimeUs : 0);
+        total += runTime[i];
+    }
+
+    printf("Thread                  load   stack used\n");
+    for (size_t i = 0; i < after.size(); i++) {
+        const ThreadStats &thread = after[i];
+        const double load = total ? runTime[i] * 100.0 / total : 0.0;
+        if (i + 1 == after.size())
+            printf("%-20s  %5.1f %%\n", "(idle)", load);
+        else if (thread.stackSize)
+            printf("%-20.*s  %5.1f %%  %5u of %5u bytes\n", static_cast<int>(sizeof(thread.name)), thread.name,
+                   load, thread.stackUsed, thread.stackSize);
+        else
+            printf("%-20.*s  %5.1f %%\n", static_cast<int>(sizeof(thread.name)), thread.name, load);
+    }
+    return 0;
+}
+
+static int showClock(Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 10.0;
+    ClockSync sync;
+
+    const auto start = Clock::now();
+    const auto duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    do {
+        int err = sync.update(device);
+        if (err != LIBUSB_SUCCESS) {
+            printf("FAIL on time request! ( %s )\n", errorName(err));
+            return -1;
+        }
+        printf("%6.1f s  %2zu points, drift %+8.3f ppm, residual %7.2f us, round trip / 2 %6.2f us\n",
+               std::chrono::duration<double>(Clock::now() - start).count(), sync.pointCount(), sync.driftPpm(),
+               sync.residualNs() / 1e3, sync.uncertaintyNs() / 1e3);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    } while (Clock::now() - start < duration);
+    return 0;
+}
+
+// Loopback with a BufferHeader on every IN buffer. Each header's device
+// time, mapped onto the host clock, is compared with the arrival time of its
+// IN transfer. Every OUT transfer fills exactly one device buffer, whose
+// payload room is one packet short of the buffer, so OUT and IN transfers
+// stay paired. With "crc" every OUT transfer ends with a CRC trailer that
+// the device checks, and every IN buffer carries one that is checked here.
+static int benchStamped(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    const bool crc = (argc > 1) && !strcmp(argv[1], "crc");
+    StreamConfig config;
+    config.flags = StreamFlagTimestamp | (crc ? (StreamFlagCrc | StreamFlagCrcCheck) : 0);
+
+    std::vector<std::pair<uint64_t, int64_t>> arrivals;
+    uint64_t buffers = 0, gaps = 0, crcErrors = 0;
+    uint32_t nextSequence = 0;
+    ClockSync sync;
+
+    StreamStatus status;
+    int err = device.setStreamConfig(config);
+    if (err == LIBUSB_SUCCESS)
+        err = device.getStreamStatus(status);
+    if ((err == LIBUSB_SUCCESS) && !status.bufferSize)
+        err = LIBUSB_ERROR_NOT_FOUND;
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+    StreamOptions options = StreamOptions::forSpeed(device.speed());
+    options.transferSize = status.bufferSize - ((device.speed() >= LIBUSB_SPEED_SUPER) ? 1024 : 512);
+    options.inTransferSize = options.transferSize + BufferHeaderSize + (crc ? CrcTrailerSize : 0);
+
+    Stream stream(device);
+    stream.setOptions(options);
+    stream.onData([&](const uint8_t *data, size_t size, uint32_t) {
+        const int64_t now = ClockSync::hostNowNs();
+        return forEachStampedBuffer(data, size, [&](const BufferHeader &header, const uint8_t *payload) {
+            if (buffers && (header.sequence != nextSequence))
+                gaps++;
+            if (crc && !checkCrc32c(payload - BufferHeaderSize, BufferHeaderSize + header.length + CrcTrailerSize))
+                crcErrors++;
+            nextSequence = header.sequence + 1;
+            buffers++;
+            arrivals.emplace_back(header.ticks(), now);
+            return true;
+        }, crc ? CrcTrailerSize : 0);
+    });
+
+    err = sync.update(device);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    auto nextSync = Clock::now() + std::chrono::seconds(1);
+    const StreamRun run = runTimedStream(ctx, stream, seconds, [crc](uint8_t *data, size_t size, uint32_t) {
+        if (crc)
+            appendCrc32c(data, size - CrcTrailerSize);
+        return size;
+    }, [&]() -> int {
+        if (Clock::now() < nextSync)
+            return LIBUSB_SUCCESS;
+        nextSync += std::chrono::seconds(1);
+        return sync.update(device);
+    });
+    err = run.error;
+    if (err == LIBUSB_SUCCESS)
+        err = sync.update(device);
+    device.setStreamConfig(StreamConfig());
+
+    std::vector<CrcStats> crcStats;
+    if (crc && (err == LIBUSB_SUCCESS))
+        err = device.getStats(StatsPageCrc, crcStats);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    std::vector<double> delays;
+    delays.reserve(arrivals.size());
+    for (const auto &arrival : arrivals)
+        delays.push_back((arrival.second - sync.toHostNs(arrival.first)) / 1e3);
+    std::sort(delays.begin(), delays.end());
+
+    printf("Buffers        : %llu, %llu sequence gaps\n", static_cast<unsigned long long>(buffers),
+           static_cast<unsigned long long>(gaps));
+    printf("Clock          : drift %+.3f ppm, residual %.2f us, round trip / 2 %.2f us\n", sync.driftPpm(),
+           sync.residualNs() / 1e3, sync.uncertaintyNs() / 1e3);
+    if (!delays.empty())
+        printf("Device to host : min %.1f us, median %.1f us, p99 %.1f us, max %.1f us\n", delays.front(),
+               delays[delays.size() / 2], delays[delays.size() * 99 / 100], delays.back());
+    if (crc) {
+        printf("CRC errors     : IN %llu", static_cast<unsigned long long>(crcErrors));
+        if (!crcStats.empty())
+            printf(", OUT %u of %u (since boot)", crcStats.front().errors, crcStats.front().checked);
+        printf("\n");
+    }
+    return 0;
+}
+
+// Half slowly changing 16-bit samples, half zeros, different per transfer
+static void fillSamples(uint8_t *data, size_t size, uint32_t sequence)
+{
+    const size_t samples = size / 4;
+    for (size_t i = 0; i < samples; i++) {
+        const uint16_t sample = static_cast<uint16_t>(sequence * 131 + ((i * 3) >> 4) + (i * 7 + sequence) % 5);
+        data[2 * i] = static_cast<uint8_t>(sample);
+        data[2 * i + 1] = static_cast<uint8_t>(sample >> 8);
+    }
+    memset(data + 2 * samples, 0, size - 2 * samples);
+}
+
+// Loopback of compressible data with StreamFlagRle and/or StreamFlagDelta16.
+// Transfers stay paired as in benchStamped, so every frame is checked
+// against the data its OUT transfer carried.
+static int benchCompress(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    const char *const mode = (argc > 1) ? argv[1] : "both";
+    StreamConfig config;
+    config.flags = StreamFlagTimestamp;
+    if (!strcmp(mode, "rle"))
+        config.flags |= StreamFlagRle;
+    else if (!strcmp(mode, "delta"))
+        config.flags |= StreamFlagDelta16;
+    else
+        config.flags |= StreamFlagRle | StreamFlagDelta16;
+
+    uint64_t frames = 0, storedFrames = 0, errors = 0, rawBytes = 0, frameBytes = 0;
+    Clock::duration decodeTime{};
+
+    StreamStatus status;
+    std::vector<CodecStats> before, after;
+    int err = device.setStreamConfig(config);
+    if (err == LIBUSB_SUCCESS)
+        err = device.getStreamStatus(status);
+    if ((err == LIBUSB_SUCCESS) && !status.bufferSize)
+        err = LIBUSB_ERROR_NOT_FOUND;
+    if (err == LIBUSB_SUCCESS)
+        err = device.getStats(StatsPageCodec, before);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+    StreamOptions options = StreamOptions::forSpeed(device.speed());
+    options.transferSize = status.bufferSize - ((device.speed() >= LIBUSB_SPEED_SUPER) ? 1024 : 512);
+    options.inTransferSize = options.transferSize + BufferHeaderSize + FrameTrailerSize;
+
+    std::vector<uint8_t> decoded(options.transferSize), expected(options.transferSize);
+    Stream stream(device);
+    stream.setOptions(options);
+    stream.onData([&](const uint8_t *data, size_t size, uint32_t) {
+        return forEachStampedBuffer(data, size, [&](const BufferHeader &header, const uint8_t *payload) {
+            size_t rawLength = 0;
+            const auto start = Clock::now();
+            const bool ok = decodeFrame(payload, header.length, decoded.data(), decoded.size(), rawLength);
+            decodeTime += Clock::now() - start;
+            fillSamples(expected.data(), expected.size(), header.sequence);
+            if (!ok || (rawLength != expected.size()) || memcmp(decoded.data(), expected.data(), rawLength))
+                errors++;
+            else if (payload[header.length - 2] == FrameTrailer::Stored)
+                storedFrames++;
+            frames++;
+            rawBytes += rawLength;
+            frameBytes += header.length;
+            return true;
+        });
+    });
+
+    const StreamRun run = runTimedStream(ctx, stream, seconds, [](uint8_t *data, size_t size, uint32_t sequence) {
+        fillSamples(data, size, sequence);
+        return size;
+    });
+    const double elapsed = run.elapsed;
+    err = run.error;
+    device.setStreamConfig(StreamConfig());
+
+    if (err == LIBUSB_SUCCESS)
+        err = device.getStats(StatsPageCodec, after);
+    if ((err == LIBUSB_SUCCESS) && (before.empty() || after.empty()))
+        err = LIBUSB_ERROR_NOT_FOUND;
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    const uint32_t deviceRaw = after.front().rawBytes - before.front().rawBytes;
+    const uint32_t deviceTicks = after.front().ticks - before.front().ticks;
+    const double decodeSeconds = std::chrono::duration<double>(decodeTime).count();
+    printf("Frames         : %llu, %llu stored, %llu errors\n", static_cast<unsigned long long>(frames),
+           static_cast<unsigned long long>(storedFrames), static_cast<unsigned long long>(errors));
+    printf("Ratio          : %.2f (%llu -> %llu bytes)\n", frameBytes ? double(rawBytes) / frameBytes : 0.0,
+           static_cast<unsigned long long>(rawBytes), static_cast<unsigned long long>(frameBytes));
+    printf("IN             : %.1f MB/s on the wire, %.1f MB/s decoded\n", frameBytes / elapsed / 1e6,
+           rawBytes / elapsed / 1e6);
+    printf("Device encode  : %.1f MB/s, longest frame %.1f us\n",
+           deviceTicks ? double(deviceRaw) * TimerHz / deviceTicks / 1e6 : 0.0, ticksToUs(after.front().maxTicks));
+    printf("Host decode    : %.1f MB/s\n", decodeSeconds > 0 ? rawBytes / decodeSeconds / 1e6 : 0.0);
+    return 0;
+}
+
+// Loopback of a generated pattern, checked as it arrives. The checker time
+// is measured separately to show how much of the line rate it costs.
+static int benchVerify(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    const char *const name = (argc > 1) ? argv[1] : "prbs";
+    Pattern pattern = Pattern::Prbs31;
+    if (!strcmp(name, "counter"))
+        pattern = Pattern::Counter;
+    else if (!strcmp(name, "constant"))
+        pattern = Pattern::Constant;
+
+    PatternGenerator generator(pattern, 0x5A);
+    PatternChecker checker(pattern, 0x5A);
+    Clock::duration checkTime{};
+
+    int err = device.setStreamConfig(StreamConfig());
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    Stream stream(device);
+    stream.setOptions(StreamOptions::forSpeed(device.speed()));
+    stream.onData([&](const uint8_t *data, size_t size, uint32_t) {
+        const auto start = Clock::now();
+        checker.check(data, size);
+        checkTime += Clock::now() - start;
+        return true;
+    });
+
+    const StreamRun run = runTimedStream(ctx, stream, seconds, [&generator](uint8_t *data, size_t size, uint32_t) {
+        generator.fill(data, size);
+        return size;
+    });
+    const double elapsed = run.elapsed;
+    if (run.error != LIBUSB_SUCCESS) {
+        printf("FAIL on stream! ( %s )\n", errorName(run.error));
+        return -1;
+    }
+
+    const double checkSeconds = std::chrono::duration<double>(checkTime).count();
+    printf("Pattern        : %s, %s checker\n", name, PatternChecker::simdName());
+    printf("IN             : %.1f MB/s, %llu bytes checked\n", stream.bytesIn() / elapsed / 1e6,
+           static_cast<unsigned long long>(checker.bytesChecked()));
+    printf("Checker        : %.1f MB/s, %.1f %% of the run\n",
+           checkSeconds > 0 ? checker.bytesChecked() / checkSeconds / 1e6 : 0.0, 100.0 * checkSeconds / elapsed);
+    printf("Errors         : %llu words", static_cast<unsigned long long>(checker.errors()));
+    if (checker.firstError() != PatternChecker::NoError)
+        printf(", first at byte %llu", static_cast<unsigned long long>(checker.firstError()));
+    printf("\n");
+    return checker.errors() ? -1 : 0;
+}
+
+// Loopback of the counter pattern through a receive -> verify -> sink
+// pipeline. The counter word at any stream offset is known, so the verify
+// workers check packets independently and in any order.
+static int benchPipeline(Context &ctx, Device &device, int argc, char *argv[])
+{
+    const double seconds = (argc > 0) ? atof(argv[0]) : 5.0;
+    const unsigned workers = (argc > 1) ? std::max(atoi(argv[1]), 1) : 2;
+    const int cpu = (argc > 2) ? atoi(argv[2]) : -1;
+    constexpr uint32_t seed = 0x5A;
+    // 16 MB at 64 KB transfers, some 40 ms of SuperSpeed data: the verify
+    // workers would have to stall that long before a transfer is dropped
+    constexpr size_t packetCount = 256;
+
+    std::atomic<uint64_t> errors{0}, sunk{0};
+    PatternGenerator generator(Pattern::Counter, seed);
+
+    Pipeline pipeline;
+    StageOptions verify;
+    verify.name = "verify";
+    verify.workers = workers;
+    verify.cpu = cpu;
+    pipeline.addStage(verify, [&errors](Packet &packet) {
+        PatternChecker checker(Pattern::Counter, seed + static_cast<uint32_t>(packet.offset / 4));
+        checker.check(packet.data, packet.size);
+        if (checker.errors())
+            errors.fetch_add(checker.errors(), std::memory_order_relaxed);
+        return true;
+    });
+    StageOptions sink;
+    sink.name = "sink";
+    sink.cpu = (cpu >= 0) ? cpu + static_cast<int>(workers) : -1;
+    pipeline.addStage(sink, [&sunk](Packet &packet) {
+        sunk.fetch_add(packet.size, std::memory_order_relaxed);
+        return true;
+    });
+
+    int err = device.setStreamConfig(StreamConfig());
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream setup! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    Stream stream(device);
+    const StreamOptions options = StreamOptions::forSpeed(device.speed());
+    stream.setOptions(options);
+    stream.onData([&pipeline](const uint8_t *data, size_t size, uint32_t sequence) {
+        // A drop is counted and reported, only a failed pipeline ends the stream
+        return pipeline.push(data, size, sequence) != LIBUSB_ERROR_OTHER;
+    });
+
+    err = pipeline.start(options.transferSize, packetCount);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on pipeline! ( %s )\n", errorName(err));
+        return -1;
+    }
+    const StreamRun run = runTimedStream(ctx, stream, seconds, [&generator](uint8_t *data, size_t size, uint32_t) {
+        generator.fill(data, size);
+        return size;
+    });
+    pipeline.stop();
+    const double elapsed = run.elapsed;
+    err = run.error;
+
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stream! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    printf("IN             : %.1f MB/s, %llu bytes through the pipeline\n", stream.bytesIn() / elapsed / 1e6,
+           static_cast<unsigned long long>(sunk.load()));
+    printf("Receive        : %llu transfers dropped, no free packet (%zu packets)\n",
+           static_cast<unsigned long long>(pipeline.drops()), packetCount);
+    printf("Stage    workers  packets      MB/s  busy   queue peak/size\n");
+    for (const StageStats &stats : pipeline.stats()) {
+        const double busy = stats.busyNs / 1e9;
+        printf("%-8s %7u  %7llu  %8.1f  %4.0f %%  %4zu/%zu\n", stats.name.c_str(), stats.workers,
+               static_cast<unsigned long long>(stats.packets), busy > 0 ? stats.bytes / busy / 1e6 : 0.0,
+               100.0 * busy / (elapsed * stats.workers), stats.peakDepth, stats.queueCapacity);
+    }
+    printf("Errors         : %llu words\n", static_cast<unsigned long long>(errors.load()));
+    return (errors.load() || pipeline.drops()) ? -1 : 0;
+}
+
+// Host CRC-32C throughput of the CPU instructions and the table loop, and
+// the device's boot time benchmark of its table loop
+static int benchCrc(Device &device, int argc, char *argv[])
+{
+    const size_t megabytes = (argc > 0) ? std::max(atoi(argv[0]), 1) : 256;
+    std::vector<uint8_t> buffer(BulkBufferSize);
+    for (size_t i = 0; i < buffer.size(); i++)
+        buffer[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+
+    struct {
+        const char *name;
+        uint32_t (*function)(uint32_t, const void *, size_t);
+    } const variants[] = { { "host, dispatched", crc32c }, { "host, slice-by-8", crc32cPortable } };
+
+    uint32_t results[2] = {};
+    for (size_t v = 0; v < 2; v++) {
+        const size_t rounds = (megabytes << 20) / buffer.size();
+        uint32_t crc = 0;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < rounds; i++)
+            crc = variants[v].function(crc, buffer.data(), buffer.size());
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        results[v] = crc;
+        printf("%-18s : %8.1f MB/s%s\n", variants[v].name, rounds * buffer.size() / seconds / 1e6,
+               (v == 0) ? (crc32cAccelerated() ? " (SSE4.2 + PCLMUL)" : " (slice-by-8)") : "");
+    }
+    if (results[0] != results[1]) {
+        printf("FAIL on CRC self check! ( 0x%08X != 0x%08X )\n", results[0], results[1]);
+        return -1;
+    }
+
+    std::vector<CrcStats> stats;
+    int err = device.getStats(StatsPageCrc, stats);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+    for (const CrcStats &crc : stats) {
+        if (!crc.benchBytes || !crc.sliceTicks || !crc.bitwiseTicks) {
+            printf("device             : no benchmark\n");
+            continue;
+        }
+        printf("device, slice-by-8 : %8.1f MB/s\n", double(crc.benchBytes) * TimerHz / crc.sliceTicks / 1e6);
+        printf("device, bitwise    : %8.1f MB/s\n", double(crc.benchBytes) * TimerHz / crc.bitwiseTicks / 1e6);
+        printf("device trailers    : %u IN appended, %u OUT checked, %u errors\n", crc.appended, crc.checked,
+               crc.errors);
+    }
+    return 0;
+}
+
+static int showStats(Device &device)
+{
+    std::vector<MemMap> maps;
+    int err = device.getStats(StatsPageMemMap, maps);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+    for (const MemMap &map : maps) {
+        printf("Memory map     : profile %u, driver heap %u KB, buffer heap %u KB (bitmap %u KB), top 0x%08X\n",
+               map.profile, map.memHeapSize >> 10, map.bufferHeapSize >> 10, map.bufferMgrSize >> 10, map.sysMemTop);
+    }
+
+    std::vector<MemPoolStats> pools;
+    err = device.getStats(StatsPageMemPool, pools);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    printf("Block pools    : size  count  in use  peak      allocs  fails\n");
+    for (const MemPoolStats &pool : pools) {
+        printf("                 %4u  %5u  %6u  %4u  %10u  %5u\n", pool.blockSize, pool.blockCount,
+               pool.inUse, pool.peak, pool.allocCount, pool.failCount);
+    }
+
+    std::vector<DmaArenaStats> arenas;
+    err = device.getStats(StatsPageDmaArena, arenas);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+    for (const DmaArenaStats &arena : arenas) {
+        printf("DMA arena      : %u x %u bytes at 0x%08X, in use %u, peak %u, allocs %u, fallbacks %u\n",
+               arena.slotCount, arena.slotSize, arena.baseAddr, arena.inUse, arena.peak,
+               arena.allocCount, arena.fallbackCount);
+    }
+
+    std::vector<MemCheckStats> checks;
+    err = device.getStats(StatsPageMemCheck, checks);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on stats request! ( %s )\n", errorName(err));
+        return -1;
+    }
+    static const char *const heapNames[] = { "driver heap", "buffer heap" };
+    for (size_t i = 0; i < checks.size(); i++) {
+        const MemCheckStats &check = checks[i];
+        printf("Heap check     : %s, %u blocks in %u steps (max %u per step), %u passes over %u blocks, %u errors\n",
+               (i < 2) ? heapNames[i] : "?", check.blockCount, check.stepCount, check.maxStepBlocks,
+               check.passCount, check.listLength, check.errorCount);
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        usage();
+        return -1;
+    }
+
+    Context ctx;
+    int err = ctx.init();
+    if (err < 0) {
+        printf("FAIL on 'libusb_init'! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    Device device;
+    err = device.open(ctx);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on device open! ( %s )\n", errorName(err));
+        return -1;
+    }
+
+    if (!strcmp(argv[1], "loopback"))
+        return benchLoopback(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "ep0"))
+        return benchEp0(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "cbtime"))
+        return benchCallbackTime(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "boot"))
+        return showBootTimeline(device);
+    if (!strcmp(argv[1], "log"))
+        return showLog(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "profile"))
+        return runProfile(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "events"))
+        return showEvents(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "latency"))
+        return showLatency(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "threads"))
+        return showThreads(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "clock"))
+        return showClock(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "stamped"))
+        return benchStamped(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "compress"))
+        return benchCompress(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "verify"))
+        return benchVerify(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "pipeline"))
+        return benchPipeline(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "crc"))
+        return benchCrc(device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "stats"))
+        return showStats(device);
+    if (!strcmp(argv[1], "ep0rt"))
+        return benchEp0Realtime(ctx, device, argc - 2, argv + 2);
+    if (!strcmp(argv[1], "ep0pipe"))
+        return benchEp0Pipelined(ctx, device, argc - 2, argv + 2);
+
+    usage();
+    return -1;
+}
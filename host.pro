@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+        libfx3link \
+        libusb-test-app \
+        fx3-bench
+
+libusb-test-app.depends = libfx3link
+fx3-bench.depends = libfx3link
@@ -0,0 +1,101 @@
+#include "fx3bufferpool.h"
+
+#include <new>
+#include <utility>
+
+namespace fx3link {
+
+static constexpr size_t BufferAlignment = 64;
+
+BufferPool::~BufferPool()
+{
+    clear();
+}
+
+BufferPool::BufferPool(BufferPool &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+BufferPool &BufferPool::operator=(BufferPool &&other) noexcept
+{
+    if (this != &other) {
+        clear();
+        std::lock_guard<std::mutex> lock(other.m_mutex);
+        m_handle = std::exchange(other.m_handle, nullptr);
+        m_bufferSize = std::exchange(other.m_bufferSize, 0);
+        m_buffers = std::move(other.m_buffers);
+        m_free = std::move(other.m_free);
+        other.m_buffers.clear();
+        other.m_free.clear();
+    }
+    return *this;
+}
+
+int BufferPool::init(Device *device, size_t bufferSize, size_t count)
+{
+    clear();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handle = device ? device->native() : nullptr;
+    m_bufferSize = bufferSize;
+    m_buffers.reserve(count);
+    m_free.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        Entry entry = { nullptr, false };
+        if (m_handle) {
+            entry.data = libusb_dev_mem_alloc(m_handle, bufferSize);
+            entry.deviceMemory = (entry.data != nullptr);
+        }
+        if (!entry.data)
+            entry.data = static_cast<uint8_t *>(::operator new(bufferSize, std::align_val_t(BufferAlignment), std::nothrow));
+        if (!entry.data)
+            return LIBUSB_ERROR_NO_MEM;
+        m_buffers.push_back(entry);
+        m_free.push_back(entry.data);
+    }
+
+    return LIBUSB_SUCCESS;
+}
+
+void BufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Entry &entry : m_buffers) {
+        if (entry.deviceMemory)
+            libusb_dev_mem_free(m_handle, entry.data, m_bufferSize);
+        else
+            ::operator delete(entry.data, std::align_val_t(BufferAlignment));
+    }
+    m_buffers.clear();
+    m_free.clear();
+    m_handle = nullptr;
+    m_bufferSize = 0;
+}
+
+uint8_t *BufferPool::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.empty())
+        return nullptr;
+    uint8_t *buffer = m_free.back();
+    m_free.pop_back();
+    return buffer;
+}
+
+void BufferPool::release(uint8_t *buffer)
+{
+    if (!buffer)
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.push_back(buffer);
+}
+
+size_t BufferPool::available() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_free.size();
+}
+
+} // namespace fx3link
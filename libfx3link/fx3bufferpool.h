@@ -0,0 +1,55 @@
+#ifndef FX3BUFFERPOOL_H
+#define FX3BUFFERPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+
+#include "fx3device.h"
+
+namespace fx3link {
+
+// Fixed number of equally sized transfer buffers, allocated once. Uses
+// libusb_dev_mem_alloc (zero-copy DMA memory) where the platform has it and
+// falls back to cache line aligned heap memory otherwise. Buffers backed by
+// device memory must be released before the device is closed. Move-only.
+class BufferPool
+{
+public:
+    BufferPool() = default;
+    ~BufferPool();
+
+    BufferPool(BufferPool &&other) noexcept;
+    BufferPool &operator=(BufferPool &&other) noexcept;
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // device may be null, then plain heap memory is used
+    int init(Device *device, size_t bufferSize, size_t count);
+    void clear();
+
+    // Returns nullptr when the pool is exhausted
+    uint8_t *acquire();
+    void release(uint8_t *buffer);
+
+    size_t bufferSize() const { return m_bufferSize; }
+    size_t count() const { return m_buffers.size(); }
+    size_t available() const;
+
+private:
+    struct Entry {
+        uint8_t *data;
+        bool deviceMemory;
+    };
+
+    libusb_device_handle *m_handle = nullptr;
+    size_t m_bufferSize = 0;
+    std::vector<Entry> m_buffers;
+    std::vector<uint8_t *> m_free;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace fx3link
+
+#endif // FX3BUFFERPOOL_H
@@ -0,0 +1,131 @@
+#include "fx3clock.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+namespace fx3link {
+
+ClockSync::ClockSync(size_t window)
+    : m_window(window ? window : 1),
+      m_nsPerTick(1e9 / TimerHz)
+{
+}
+
+int64_t ClockSync::hostNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int ClockSync::update(Device &device, unsigned burst)
+{
+    Point best = {0, 0, -1};
+    for (unsigned i = 0; i < (burst ? burst : 1); i++) {
+        TimeSample sample;
+        const int64_t before = hostNowNs();
+        int err = device.readTime(sample);
+        const int64_t after = hostNowNs();
+        if (err != LIBUSB_SUCCESS)
+            return err;
+        if ((best.roundTripNs < 0) || (after - before < best.roundTripNs))
+            best = {sample.ticks(), before + (after - before) / 2, after - before};
+    }
+    addPoint(best);
+    return LIBUSB_SUCCESS;
+}
+
+void ClockSync::addPoint(const Point &point)
+{
+    m_points.push_back(point);
+    while (m_points.size() > m_window)
+        m_points.pop_front();
+    fit();
+}
+
+void ClockSync::reset()
+{
+    m_points.clear();
+    m_tickRef = 0;
+    m_hostRef = 0;
+    m_nsPerTick = 1e9 / TimerHz;
+    m_residualNs = 0;
+}
+
+void ClockSync::fit()
+{
+    const Point &first = m_points.front();
+    m_tickRef = first.deviceTicks;
+    m_hostRef = first.hostNs;
+    m_residualNs = 0;
+    if (m_points.size() < 2) {
+        m_nsPerTick = 1e9 / TimerHz;
+        return;
+    }
+
+    // Relative to the oldest point, so doubles keep the nanoseconds
+    double meanX = 0, meanY = 0;
+    for (const Point &p : m_points) {
+        meanX += double(int64_t(p.deviceTicks - m_tickRef));
+        meanY += double(p.hostNs - m_hostRef);
+    }
+    meanX /= m_points.size();
+    meanY /= m_points.size();
+
+    double sxx = 0, sxy = 0;
+    for (const Point &p : m_points) {
+        const double dx = double(int64_t(p.deviceTicks - m_tickRef)) - meanX;
+        sxx += dx * dx;
+        sxy += dx * (double(p.hostNs - m_hostRef) - meanY);
+    }
+    if (sxx > 0)
+        m_nsPerTick = sxy / sxx;
+    m_hostRef += llround(meanY - m_nsPerTick * meanX);
+
+    for (const Point &p : m_points) {
+        const int64_t error = p.hostNs - toHostNs(p.deviceTicks);
+        m_residualNs = std::max(m_residualNs, error < 0 ? -error : error);
+    }
+}
+
+int64_t ClockSync::toHostNs(uint64_t deviceTicks) const
+{
+    return m_hostRef + llround(double(int64_t(deviceTicks - m_tickRef)) * m_nsPerTick);
+}
+
+double ClockSync::driftPpm() const
+{
+    return (deviceHz() / TimerHz - 1.0) * 1e6;
+}
+
+int64_t ClockSync::uncertaintyNs() const
+{
+    int64_t best = -1;
+    for (const Point &p : m_points) {
+        if ((best < 0) || (p.roundTripNs < best))
+            best = p.roundTripNs;
+    }
+    return (best < 0) ? 0 : best / 2;
+}
+
+bool forEachStampedBuffer(const uint8_t *data, size_t size, const StampedBufferHandler &handler,
+                          size_t trailerSize)
+{
+    size_t offset = 0;
+    while (offset < size) {
+        BufferHeader header;
+        if (size - offset < sizeof(header))
+            return false;
+        memcpy(&header, data + offset, sizeof(header));
+        offset += sizeof(header);
+        if (header.length > size - offset || trailerSize > size - offset - header.length)
+            return false;
+        if (!handler(header, data + offset))
+            return false;
+        offset += header.length + trailerSize;
+    }
+    return true;
+}
+
+} // namespace fx3link
@@ -0,0 +1,74 @@
+#ifndef FX3CLOCK_H
+#define FX3CLOCK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <functional>
+
+#include "fx3device.h"
+
+namespace fx3link {
+
+// Maps the 64-bit device clock (BufferHeader, TimeSample) onto the host's
+// std::chrono::steady_clock, which is CLOCK_MONOTONIC on Linux. Each update
+// takes a burst of TimeRequest round trips and keeps the one with the
+// shortest round trip, pairing the device ticks with the host midpoint; a
+// least squares line through the last 'window' of those points gives the
+// offset and the drift. Not thread-safe.
+class ClockSync
+{
+public:
+    struct Point {
+        uint64_t deviceTicks;
+        int64_t hostNs;         // Midpoint of the round trip
+        int64_t roundTripNs;
+    };
+
+    explicit ClockSync(size_t window = 32);
+
+    // Takes one point; call every second or so to follow the drift
+    int update(Device &device, unsigned burst = 8);
+    void addPoint(const Point &point);
+    void reset();
+
+    // At least one point; with one the nominal TimerHz is assumed
+    bool isValid() const { return !m_points.empty(); }
+    size_t pointCount() const { return m_points.size(); }
+
+    // Host steady_clock time in ns of a device timestamp
+    int64_t toHostNs(uint64_t deviceTicks) const;
+    // Fitted device clock rate and its deviation from TimerHz
+    double deviceHz() const { return 1e9 / m_nsPerTick; }
+    double driftPpm() const;
+    // Largest distance of a point from the line, and the best half round
+    // trip: together a bound on the mapping error
+    int64_t residualNs() const { return m_residualNs; }
+    int64_t uncertaintyNs() const;
+
+    static int64_t hostNowNs();
+
+private:
+    void fit();
+
+    size_t m_window;
+    std::deque<Point> m_points;
+    uint64_t m_tickRef = 0;
+    int64_t m_hostRef = 0;
+    double m_nsPerTick;
+    int64_t m_residualNs = 0;
+};
+
+// Walks the device buffers of one IN transfer made with StreamFlagTimestamp.
+// Returns false if a header runs past the end of the data or the handler
+// returns false. Pass CrcTrailerSize as trailerSize for a stream made with
+// StreamFlagCrc; the header bytes start BufferHeaderSize before the payload,
+// so checkCrc32c(payload - BufferHeaderSize, BufferHeaderSize + length +
+// CrcTrailerSize) verifies a buffer.
+using StampedBufferHandler = std::function<bool(const BufferHeader &header, const uint8_t *payload)>;
+bool forEachStampedBuffer(const uint8_t *data, size_t size, const StampedBufferHandler &handler,
+                          size_t trailerSize = 0);
+
+} // namespace fx3link
+
+#endif // FX3CLOCK_H
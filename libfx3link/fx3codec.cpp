@@ -0,0 +1,150 @@
+#include "fx3codec.h"
+
+#include <string.h>
+#include <vector>
+
+#include "fx3protocol.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define FX3_CODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace fx3link {
+
+// Expands runs and literals into exactly rawLength bytes
+static bool decodeRle(const uint8_t *in, size_t size, uint8_t *out, size_t rawLength)
+{
+    const uint8_t *const end = in + size;
+    uint8_t *const outEnd = out + rawLength;
+
+    while (in < end) {
+        const uint8_t control = *in++;
+        if (control < 0x80) {
+            const size_t count = size_t(control) + 1;
+            if ((size_t(end - in) < count) || (size_t(outEnd - out) < count))
+                return false;
+            memcpy(out, in, count);
+            in += count;
+            out += count;
+        } else {
+            const size_t count = size_t(control) - 0x80 + 3;
+            if ((in == end) || (size_t(outEnd - out) < count))
+                return false;
+            memset(out, *in++, count);
+            out += count;
+        }
+    }
+    return out == outEnd;
+}
+
+static inline void storeSample(uint8_t *out, uint16_t sample)
+{
+    out[0] = static_cast<uint8_t>(sample);
+    out[1] = static_cast<uint8_t>(sample >> 8);
+}
+
+// Sums the deltas back into rawLength bytes of little-endian samples
+static bool decodeDelta16(const uint8_t *in, size_t size, uint8_t *out, size_t rawLength)
+{
+    const uint8_t *const end = in + size;
+    const size_t count = rawLength / 2;
+    uint16_t prev = 0;
+    size_t n = 0;
+
+    while (n < count) {
+#if defined(FX3_CODEC_SSE2)
+        // Sixteen one-byte deltas: sign extend, prefix sum within each half,
+        // then carry the previous sample in
+        if ((count - n >= 16) && (end - in >= 16)) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+            if (!_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80))))) {
+                const __m128i sign = _mm_cmplt_epi8(bytes, _mm_setzero_si128());
+                __m128i lo = _mm_unpacklo_epi8(bytes, sign);
+                __m128i hi = _mm_unpackhi_epi8(bytes, sign);
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 2));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 2));
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 4));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 4));
+                lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 8));
+                hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 8));
+                lo = _mm_add_epi16(lo, _mm_set1_epi16(static_cast<short>(prev)));
+                hi = _mm_add_epi16(hi, _mm_shuffle_epi32(_mm_shufflehi_epi16(lo, 0xFF), 0xFF));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * n), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * n + 16), hi);
+                prev = static_cast<uint16_t>(_mm_extract_epi16(hi, 7));
+                in += 16;
+                n += 16;
+                continue;
+            }
+        }
+#endif
+        if (in == end)
+            return false;
+        const uint8_t delta = *in++;
+        if (delta == 0x80) {
+            if (end - in < 2)
+                return false;
+            prev = static_cast<uint16_t>(in[0] | (in[1] << 8));
+            in += 2;
+        } else {
+            prev = static_cast<uint16_t>(prev + static_cast<int8_t>(delta));
+        }
+        storeSample(out + 2 * n, prev);
+        n++;
+    }
+
+    if (rawLength & 1) {
+        if (in == end)
+            return false;
+        out[rawLength - 1] = *in++;
+    }
+    return in == end;
+}
+
+bool decodeFrame(const uint8_t *frame, size_t size, uint8_t *out, size_t capacity, size_t &rawLength)
+{
+    if (size < FrameTrailerSize)
+        return false;
+    size -= FrameTrailerSize;
+
+    FrameTrailer trailer;
+    memcpy(&trailer, frame + size, sizeof(trailer));
+    rawLength = trailer.rawLength;
+    if (rawLength > capacity)
+        return false;
+
+    switch (trailer.codec) {
+    case FrameTrailer::Stored:
+        if (size != rawLength)
+            return false;
+        memcpy(out, frame, size);
+        return true;
+    case FrameTrailer::Rle:
+        return decodeRle(frame, size, out, rawLength);
+    case FrameTrailer::Delta16:
+        return decodeDelta16(frame, size, out, rawLength);
+    case FrameTrailer::Delta16 | FrameTrailer::Rle: {
+        // The device only keeps deltas that came out shorter than the payload
+        thread_local std::vector<uint8_t> deltas;
+        deltas.resize(rawLength);
+        size_t deltaLength = 0;
+        const uint8_t *in = frame;
+        const uint8_t *const end = frame + size;
+        while (in < end) {
+            const uint8_t control = *in;
+            const size_t count = (control < 0x80) ? size_t(control) + 1 : size_t(control) - 0x80 + 3;
+            in += (control < 0x80) ? count + 1 : 2;
+            deltaLength += count;
+        }
+        if ((in != end) || (deltaLength > rawLength))
+            return false;
+        return decodeRle(frame, size, deltas.data(), deltaLength)
+            && decodeDelta16(deltas.data(), deltaLength, out, rawLength);
+    }
+    default:
+        return false;
+    }
+}
+
+} // namespace fx3link
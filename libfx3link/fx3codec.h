@@ -0,0 +1,21 @@
+#ifndef FX3CODEC_H
+#define FX3CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fx3link {
+
+// Decoder for the frames of a stream made with StreamFlagRle or
+// StreamFlagDelta16 (src/cyfxcodec.h): the payload of each BufferHeader,
+// header.length bytes, encoded bytes first and a FrameTrailer last. Runs
+// are expanded with memset/memcpy; the 16-bit deltas are summed sixteen
+// at a time with SSE2 while no escape byte is in the way.
+//
+// Writes the raw payload to out and its length to rawLength. Returns false
+// if the frame is malformed or its payload is larger than capacity.
+bool decodeFrame(const uint8_t *frame, size_t size, uint8_t *out, size_t capacity, size_t &rawLength);
+
+} // namespace fx3link
+
+#endif // FX3CODEC_H
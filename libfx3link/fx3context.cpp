@@ -0,0 +1,46 @@
+#include "fx3context.h"
+
+#include <utility>
+
+namespace fx3link {
+
+const char *errorName(int error)
+{
+    return libusb_error_name(error);
+}
+
+Context::~Context()
+{
+    exit();
+}
+
+Context::Context(Context &&other) noexcept
+    : m_ctx(std::exchange(other.m_ctx, nullptr))
+{
+}
+
+Context &Context::operator=(Context &&other) noexcept
+{
+    if (this != &other) {
+        exit();
+        m_ctx = std::exchange(other.m_ctx, nullptr);
+    }
+    return *this;
+}
+
+int Context::init()
+{
+    if (m_ctx)
+        return LIBUSB_SUCCESS;
+    return libusb_init(&m_ctx);
+}
+
+void Context::exit()
+{
+    if (m_ctx) {
+        libusb_exit(m_ctx);
+        m_ctx = nullptr;
+    }
+}
+
+} // namespace fx3link
@@ -0,0 +1,35 @@
+#ifndef FX3CONTEXT_H
+#define FX3CONTEXT_H
+
+#include <libusb.h>
+
+namespace fx3link {
+
+// Returns a printable name of a libusb error code
+const char *errorName(int error);
+
+// Owns a libusb context. Move-only.
+class Context
+{
+public:
+    Context() = default;
+    ~Context();
+
+    Context(Context &&other) noexcept;
+    Context &operator=(Context &&other) noexcept;
+    Context(const Context &) = delete;
+    Context &operator=(const Context &) = delete;
+
+    int init();
+    void exit();
+
+    bool isValid() const { return m_ctx != nullptr; }
+    libusb_context *native() const { return m_ctx; }
+
+private:
+    libusb_context *m_ctx = nullptr;
+};
+
+} // namespace fx3link
+
+#endif // FX3CONTEXT_H
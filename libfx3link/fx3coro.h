@@ -0,0 +1,376 @@
+#ifndef FX3CORO_H
+#define FX3CORO_H
+
+// C++20 coroutine layer on top of Transfer. Header-only, so the rest of the
+// library keeps building as C++17; include it from C++20 code only.
+//
+// Completions resume the awaiting coroutine directly from the libusb
+// callback, i.e. on the EventLoop thread. An Operation owns its transfer
+// and buffer for its whole life, so awaiting a transfer does not allocate;
+// coroutine frames come from a size-class pool and are recycled.
+
+#include <stdint.h>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fx3device.h"
+#include "fx3transfer.h"
+
+namespace fx3link {
+namespace coro {
+
+// Free lists of coroutine frames in power of two size classes, shared by
+// all threads. A frame is often allocated on one thread and freed on
+// another (syncWait starts a task on the caller, its last completion runs
+// on the event thread), so per-thread lists would only ever grow on one
+// side and allocate on the other. The lock is held for a list push or pop.
+class FramePool
+{
+public:
+    static void *allocate(size_t size)
+    {
+        const int cls = sizeClass(size);
+        if (cls < 0)
+            return ::operator new(size);
+        Lists &lists = sharedLists();
+        {
+            std::lock_guard<std::mutex> lock(lists.mutex);
+            if (FreeFrame *frame = lists.head[cls]) {
+                lists.head[cls] = frame->next;
+                return frame;
+            }
+        }
+        return ::operator new(classSize(cls));
+    }
+
+    static void deallocate(void *ptr, size_t size)
+    {
+        const int cls = sizeClass(size);
+        if (cls < 0) {
+            ::operator delete(ptr);
+            return;
+        }
+        Lists &lists = sharedLists();
+        FreeFrame *frame = static_cast<FreeFrame *>(ptr);
+        std::lock_guard<std::mutex> lock(lists.mutex);
+        frame->next = lists.head[cls];
+        lists.head[cls] = frame;
+    }
+
+private:
+    static constexpr int MinShift = 7;   // 128 bytes
+    static constexpr int Classes = 6;    // up to 4 KB
+
+    struct FreeFrame {
+        FreeFrame *next;
+    };
+
+    struct Lists {
+        std::mutex mutex;
+        FreeFrame *head[Classes] = {};
+        ~Lists()
+        {
+            for (FreeFrame *frame : head) {
+                while (frame) {
+                    FreeFrame *next = frame->next;
+                    ::operator delete(frame);
+                    frame = next;
+                }
+            }
+        }
+    };
+
+    static int sizeClass(size_t size)
+    {
+        for (int cls = 0; cls < Classes; cls++) {
+            if (size <= classSize(cls))
+                return cls;
+        }
+        return -1;
+    }
+    static constexpr size_t classSize(int cls) { return size_t(1) << (MinShift + cls); }
+
+    static Lists &sharedLists()
+    {
+        static Lists lists;
+        return lists;
+    }
+};
+
+struct PooledFrame {
+    static void *operator new(size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void *ptr, size_t size) { FramePool::deallocate(ptr, size); }
+};
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct PromiseBase : PooledFrame {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+        {
+            std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    T value{};
+    Task<T> get_return_object() noexcept;
+    void return_value(T v) { value = std::move(v); }
+    T result()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+        return std::move(value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void result()
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+};
+
+} // namespace detail
+
+// Lazily started coroutine. Runs when awaited; the awaiting coroutine is
+// resumed when it finishes (symmetric transfer, no stack growth).
+template <typename T>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = detail::Promise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+    ~Task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    bool await_ready() const noexcept { return !m_handle || m_handle.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+    T await_resume() { return m_handle.promise().result(); }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail {
+
+template <typename T>
+inline Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+// Eagerly started, self-destroying coroutine used to run a Task from
+// non-coroutine code
+struct Detached {
+    struct promise_type : PooledFrame {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct Latch {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t pending = 0;
+
+    void countDown()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0)
+            cv.notify_all();
+    }
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return pending == 0; });
+    }
+};
+
+template <typename T>
+Detached runAndSignal(Task<T> &task, T *result, Latch *latch)
+{
+    *result = co_await task;
+    latch->countDown();
+}
+
+inline Detached runAndSignal(Task<void> &task, void *, Latch *latch)
+{
+    co_await task;
+    latch->countDown();
+}
+
+} // namespace detail
+
+// Runs a task and blocks the calling thread until it finishes. An EventLoop
+// must be running, and this must not be called from the event thread.
+template <typename T>
+T syncWait(Task<T> task)
+{
+    detail::Latch latch;
+    latch.pending = 1;
+    if constexpr (std::is_void_v<T>) {
+        detail::runAndSignal(task, nullptr, &latch);
+        latch.wait();
+    } else {
+        T result{};
+        detail::runAndSignal(task, &result, &latch);
+        latch.wait();
+        return result;
+    }
+}
+
+// Runs all tasks concurrently and blocks until every one has finished
+template <typename T>
+std::vector<T> syncWaitAll(std::vector<Task<T>> &tasks)
+{
+    detail::Latch latch;
+    std::vector<T> results(tasks.size());
+    latch.pending = tasks.size();
+    if (tasks.empty())
+        return results;
+    for (size_t i = 0; i < tasks.size(); i++)
+        detail::runAndSignal(tasks[i], &results[i], &latch);
+    latch.wait();
+    return results;
+}
+
+struct TransferResult {
+    int error;          // LIBUSB_SUCCESS or a libusb error code
+    int actualLength;   // Data bytes transferred (without the control setup packet)
+};
+
+// Reusable transfer owned by one coroutine at a time. The transfer and its
+// buffer are allocated once; each co_await only submits it.
+class Operation
+{
+public:
+    Operation(Device &device, size_t bufferSize)
+        : m_device(device), m_buffer(LIBUSB_CONTROL_SETUP_SIZE + bufferSize)
+    {
+        m_transfer.setCallback([this](Transfer &) { std::exchange(m_waiter, nullptr).resume(); });
+    }
+
+    Operation(const Operation &) = delete;
+    Operation &operator=(const Operation &) = delete;
+
+    // Data area for bulk transfers and control requests
+    uint8_t *data() { return m_buffer.data() + LIBUSB_CONTROL_SETUP_SIZE; }
+    size_t size() const { return m_buffer.size() - LIBUSB_CONTROL_SETUP_SIZE; }
+
+    class Awaiter
+    {
+    public:
+        explicit Awaiter(Operation &op) : m_op(op) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            m_op.m_waiter = h;
+            // Once submitted, the completion may resume the coroutine on the
+            // event thread and free its frame, this awaiter included, before
+            // submit() returns; only the failure path may touch it
+            const int err = m_op.m_transfer.submit();
+            if (err == LIBUSB_SUCCESS)
+                return true;
+            m_op.m_waiter = nullptr;
+            m_submitError = err;
+            return false;
+        }
+        TransferResult await_resume() const
+        {
+            if (m_submitError != LIBUSB_SUCCESS)
+                return { m_submitError, 0 };
+            return { m_op.m_transfer.error(), m_op.m_transfer.actualLength() };
+        }
+
+    private:
+        Operation &m_op;
+        int m_submitError = LIBUSB_SUCCESS;
+    };
+
+    Awaiter bulk(uint8_t endpoint, int length, unsigned timeout = DefaultTimeout)
+    {
+        m_transfer.fillBulk(m_device, endpoint, data(), length, timeout);
+        return Awaiter(*this);
+    }
+
+    Awaiter controlOut(uint8_t request, uint16_t value, uint16_t length, unsigned timeout = DefaultTimeout)
+    {
+        m_transfer.fillControl(m_device, LIBUSB_ENDPOINT_OUT, request, value, m_buffer.data(), length, timeout);
+        return Awaiter(*this);
+    }
+
+    Awaiter controlIn(uint8_t request, uint16_t value, uint16_t length, unsigned timeout = DefaultTimeout)
+    {
+        m_transfer.fillControl(m_device, LIBUSB_ENDPOINT_IN, request, value, m_buffer.data(), length, timeout);
+        return Awaiter(*this);
+    }
+
+private:
+    Device &m_device;
+    std::vector<uint8_t> m_buffer;
+    Transfer m_transfer;
+    std::coroutine_handle<> m_waiter;
+};
+
+} // namespace coro
+} // namespace fx3link
+
+#endif // FX3CORO_H
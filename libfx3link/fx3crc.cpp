@@ -0,0 +1,217 @@
+#include "fx3crc.h"
+
+#include <string.h>
+
+#include "fx3protocol.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FX3_CRC_X86 1
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FX3_CRC_TARGET
+#else
+#include <cpuid.h>
+#define FX3_CRC_TARGET __attribute__((target("sse4.2,pclmul")))
+#endif
+#endif
+
+namespace fx3link {
+
+static constexpr uint32_t Poly = 0x82F63B78;    // CY_FX_CRC_POLY, reflected
+
+namespace {
+
+struct Tables {
+    uint32_t t[8][256];
+
+    Tables()
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; k++)
+                crc = (crc & 1) ? (crc >> 1) ^ Poly : (crc >> 1);
+            t[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++)
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+        }
+    }
+};
+
+const Tables &tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+} // namespace
+
+uint32_t crc32cPortable(uint32_t crc, const void *data, size_t size)
+{
+    const uint32_t (*t)[256] = tables().t;
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+
+    crc = ~crc;
+    while (size >= 8) {
+        uint32_t one, two;
+        memcpy(&one, p, 4);
+        memcpy(&two, p + 4, 4);
+        one ^= crc;
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+            ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return ~crc;
+}
+
+#if defined(FX3_CRC_X86)
+
+// Bytes per lane per round. Three lanes hide the CRC32 latency of three
+// cycles; the lanes are merged once per round.
+static constexpr size_t LaneBytes = 1024;
+
+// x^n modulo the polynomial, bit-reflected: x^0 is 0x80000000
+static uint32_t multModP(uint32_t a, uint32_t b)
+{
+    uint32_t product = 0;
+    for (uint32_t m = 0x80000000u; m; m >>= 1) {
+        if (a & m)
+            product ^= b;
+        b = (b & 1) ? (b >> 1) ^ Poly : (b >> 1);
+    }
+    return product;
+}
+
+static uint32_t xPowModP(uint64_t n)
+{
+    uint32_t result = 0x80000000u;
+    uint32_t square = 0x40000000u;      // x^1
+    for (; n; n >>= 1) {
+        if (n & 1)
+            result = multModP(result, square);
+        square = multModP(square, square);
+    }
+    return result;
+}
+
+// Constant that moves a lane CRC past 'bytes' more bytes: the 64-bit
+// carry-less product of crc and x^(8 * bytes - 33), reduced by CRC32 of the
+// product, is crc * x^(8 * bytes)
+static uint32_t shiftConstant(size_t bytes)
+{
+    return xPowModP(8 * uint64_t(bytes) - 33);
+}
+
+FX3_CRC_TARGET static inline uint32_t shiftLane(uint32_t crc, uint32_t constant)
+{
+    const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crc)),
+                                                 _mm_cvtsi32_si128(static_cast<int>(constant)), 0);
+    return static_cast<uint32_t>(_mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product))));
+}
+
+FX3_CRC_TARGET static uint32_t crc32cHardware(uint32_t crc, const uint8_t *p, size_t size)
+{
+    static const uint32_t shiftOne = shiftConstant(LaneBytes);
+    static const uint32_t shiftTwo = shiftConstant(2 * LaneBytes);
+    uint64_t crc0 = ~crc;
+
+    while (size && (reinterpret_cast<uintptr_t>(p) & 7)) {
+        crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *p++);
+        size--;
+    }
+
+    while (size >= 3 * LaneBytes) {
+        uint64_t crc1 = 0, crc2 = 0;
+        for (size_t i = 0; i < LaneBytes; i += 8) {
+            uint64_t word0, word1, word2;
+            memcpy(&word0, p + i, 8);
+            memcpy(&word1, p + LaneBytes + i, 8);
+            memcpy(&word2, p + 2 * LaneBytes + i, 8);
+            crc0 = _mm_crc32_u64(crc0, word0);
+            crc1 = _mm_crc32_u64(crc1, word1);
+            crc2 = _mm_crc32_u64(crc2, word2);
+        }
+        crc0 = shiftLane(static_cast<uint32_t>(crc0), shiftTwo) ^ shiftLane(static_cast<uint32_t>(crc1), shiftOne) ^ crc2;
+        p += 3 * LaneBytes;
+        size -= 3 * LaneBytes;
+    }
+
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        crc0 = _mm_crc32_u64(crc0, word);
+        p += 8;
+        size -= 8;
+    }
+    while (size--)
+        crc0 = _mm_crc32_u8(static_cast<uint32_t>(crc0), *p++);
+    return ~static_cast<uint32_t>(crc0);
+}
+
+static bool detectHardware()
+{
+    unsigned ecx;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = static_cast<unsigned>(info[2]);
+#else
+    unsigned eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+#endif
+    return (ecx & (1u << 20)) && (ecx & (1u << 1));     // SSE4.2, PCLMULQDQ
+}
+
+bool crc32cAccelerated()
+{
+    static const bool accelerated = detectHardware();
+    return accelerated;
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t size)
+{
+    if (crc32cAccelerated())
+        return crc32cHardware(crc, static_cast<const uint8_t *>(data), size);
+    return crc32cPortable(crc, data, size);
+}
+
+#else
+
+bool crc32cAccelerated()
+{
+    return false;
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t size)
+{
+    return crc32cPortable(crc, data, size);
+}
+
+#endif
+
+void appendCrc32c(uint8_t *data, size_t size)
+{
+    const uint32_t crc = crc32c(0, data, size);
+    for (size_t i = 0; i < CrcTrailerSize; i++)
+        data[size + i] = static_cast<uint8_t>(crc >> (8 * i));
+}
+
+bool checkCrc32c(const uint8_t *data, size_t size)
+{
+    if (size < CrcTrailerSize)
+        return false;
+    size -= CrcTrailerSize;
+    uint32_t trailer = 0;
+    for (size_t i = 0; i < CrcTrailerSize; i++)
+        trailer |= uint32_t(data[size + i]) << (8 * i);
+    return crc32c(0, data, size) == trailer;
+}
+
+} // namespace fx3link
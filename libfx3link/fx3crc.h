@@ -0,0 +1,27 @@
+#ifndef FX3CRC_H
+#define FX3CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fx3link {
+
+// CRC-32C (Castagnoli), the stream trailer check shared with the firmware
+// (src/cyfxcrc.h). Incremental: start from 0 and feed the previous result
+// back with the next piece of data. On x86-64 CPUs with SSE4.2 and PCLMUL
+// the CRC32 instruction runs on three interleaved lanes that are merged
+// with carry-less multiplies; elsewhere a slice-by-8 table loop, the same
+// algorithm as the firmware's.
+uint32_t crc32c(uint32_t crc, const void *data, size_t size);
+uint32_t crc32cPortable(uint32_t crc, const void *data, size_t size);
+// Whether crc32c() uses the CPU instructions
+bool crc32cAccelerated();
+
+// Writes the little-endian CRC of size bytes behind them (CrcTrailerSize more)
+void appendCrc32c(uint8_t *data, size_t size);
+// Checks the trailer at the end of size bytes, trailer included
+bool checkCrc32c(const uint8_t *data, size_t size);
+
+} // namespace fx3link
+
+#endif // FX3CRC_H
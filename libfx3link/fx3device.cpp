@@ -0,0 +1,255 @@
+#include "fx3device.h"
+
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace fx3link {
+
+static std::string stringDescriptor(libusb_device_handle *handle, uint8_t index)
+{
+    unsigned char data[128];
+    if (index == 0)
+        return std::string();
+    int len = libusb_get_string_descriptor_ascii(handle, index, data, sizeof(data));
+    if (len < 0)
+        return std::string();
+    return std::string(reinterpret_cast<const char *>(data), static_cast<size_t>(len));
+}
+
+Device::~Device()
+{
+    close();
+}
+
+Device::Device(Device &&other) noexcept
+    : m_handle(std::exchange(other.m_handle, nullptr)),
+      m_info(std::move(other.m_info))
+{
+}
+
+Device &Device::operator=(Device &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        m_handle = std::exchange(other.m_handle, nullptr);
+        m_info = std::move(other.m_info);
+    }
+    return *this;
+}
+
+int Device::open(Context &ctx, uint16_t vid, uint16_t pid)
+{
+    close();
+
+    libusb_device **list;
+    ssize_t cnt = libusb_get_device_list(ctx.native(), &list);
+    if (cnt < 0)
+        return static_cast<int>(cnt);
+
+    int err = LIBUSB_ERROR_NOT_FOUND;
+    libusb_device_descriptor desc;
+    for (ssize_t i = 0; i < cnt; i++) {
+        if (libusb_get_device_descriptor(list[i], &desc) != LIBUSB_SUCCESS)
+            continue;
+        if ((desc.idVendor != vid) || (desc.idProduct != pid))
+            continue;
+        err = libusb_open(list[i], &m_handle);
+        break;
+    }
+    libusb_free_device_list(list, 1);
+    if (err != LIBUSB_SUCCESS) {
+        m_handle = nullptr;
+        return err;
+    }
+
+    err = libusb_claim_interface(m_handle, Interface);
+    if (err != LIBUSB_SUCCESS) {
+        libusb_close(m_handle);
+        m_handle = nullptr;
+        return err;
+    }
+
+    m_info.vid = desc.idVendor;
+    m_info.pid = desc.idProduct;
+    m_info.bcdUSB = desc.bcdUSB;
+    m_info.bcdDevice = desc.bcdDevice;
+    m_info.manufacturer = stringDescriptor(m_handle, desc.iManufacturer);
+    m_info.product = stringDescriptor(m_handle, desc.iProduct);
+    m_info.serialNumber = stringDescriptor(m_handle, desc.iSerialNumber);
+    return LIBUSB_SUCCESS;
+}
+
+void Device::close()
+{
+    if (m_handle) {
+        libusb_release_interface(m_handle, Interface);
+        libusb_close(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+int Device::speed() const
+{
+    if (!m_handle)
+        return LIBUSB_SPEED_UNKNOWN;
+    return libusb_get_device_speed(libusb_get_device(m_handle));
+}
+
+int Device::controlOut(uint8_t request, uint16_t value, const void *data, uint16_t length, unsigned timeout)
+{
+    return libusb_control_transfer(m_handle,
+                                   LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
+                                   request, value, Interface,
+                                   static_cast<unsigned char *>(const_cast<void *>(data)), length, timeout);
+}
+
+int Device::controlIn(uint8_t request, uint16_t value, void *data, uint16_t length, unsigned timeout)
+{
+    return libusb_control_transfer(m_handle,
+                                   LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
+                                   request, value, Interface,
+                                   static_cast<unsigned char *>(data), length, timeout);
+}
+
+int Device::setStreamConfig(const StreamConfig &config, unsigned timeout)
+{
+    StreamStatus status;
+    int err = getStreamStatus(status);
+    if (err != LIBUSB_SUCCESS)
+        return err;
+    const uint16_t configCount = status.configCount;
+
+    err = controlOut(StreamRequest, 0, &config, sizeof(config));
+    if (err < 0)
+        return err;
+
+    // The device acks the request before its worker thread rebuilds the
+    // channel; configCount moves on once it is done
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    for (;;) {
+        err = getStreamStatus(status);
+        if (err != LIBUSB_SUCCESS)
+            return err;
+        if (status.configCount != configCount)
+            return (status.configStatus == 0) ? LIBUSB_SUCCESS : LIBUSB_ERROR_OTHER;
+        if (std::chrono::steady_clock::now() >= deadline)
+            return LIBUSB_ERROR_TIMEOUT;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+int Device::getStreamStatus(StreamStatus &status)
+{
+    int err = controlIn(StreamRequest, 0, &status, sizeof(status));
+    if (err < 0)
+        return err;
+    return (err == sizeof(status)) ? LIBUSB_SUCCESS : LIBUSB_ERROR_IO;
+}
+
+int Device::getStatsPage(uint16_t page, std::vector<uint8_t> &data)
+{
+    data.resize(StatsBufferSize);
+    int err = controlIn(StatsRequest, page, data.data(), static_cast<uint16_t>(data.size()));
+    if (err < 0)
+        return err;
+    if (err < static_cast<int>(sizeof(StatsHeader)))
+        return LIBUSB_ERROR_IO;
+
+    StatsHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (sizeof(header) + size_t(header.count) * header.recordSize > size_t(err))
+        return LIBUSB_ERROR_IO;
+
+    data.resize(err);
+    return LIBUSB_SUCCESS;
+}
+
+int Device::readLog(std::vector<LogRecord> &records, uint32_t &lost)
+{
+    std::vector<uint8_t> data(LogBufferSize);
+    int err = controlIn(LogRequest, 0, data.data(), static_cast<uint16_t>(data.size()));
+    if (err < 0)
+        return err;
+    if (err < static_cast<int>(sizeof(LogHeader)))
+        return LIBUSB_ERROR_IO;
+
+    LogHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.recordSize != sizeof(LogRecord))
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+    if (sizeof(header) + size_t(header.count) * sizeof(LogRecord) > size_t(err))
+        return LIBUSB_ERROR_IO;
+
+    const size_t first = records.size();
+    records.resize(first + header.count);
+    memcpy(records.data() + first, data.data() + sizeof(header), header.count * sizeof(LogRecord));
+    lost = header.lost;
+    return LIBUSB_SUCCESS;
+}
+
+int Device::startProfile(uint16_t rateHz)
+{
+    int err = controlOut(ProfileRequest, rateHz, nullptr, 0);
+    return (err < 0) ? err : LIBUSB_SUCCESS;
+}
+
+int Device::readProfile(ProfileSummary &summary, std::vector<ProfileThread> &threads, std::vector<ProfilePc> &pcs)
+{
+    std::vector<uint8_t> data(StatsBufferSize);
+    int err = controlIn(ProfileRequest, 0, data.data(), static_cast<uint16_t>(data.size()));
+    if (err < 0)
+        return err;
+    if (err < static_cast<int>(sizeof(summary)))
+        return LIBUSB_ERROR_IO;
+    memcpy(&summary, data.data(), sizeof(summary));
+    if (sizeof(summary) + size_t(summary.threadCount) * sizeof(ProfileThread) > size_t(err))
+        return LIBUSB_ERROR_IO;
+    threads.resize(summary.threadCount);
+    memcpy(threads.data(), data.data() + sizeof(summary), threads.size() * sizeof(ProfileThread));
+
+    pcs.clear();
+    for (uint16_t chunk = 1; chunk <= summary.pcChunks; chunk++) {
+        err = controlIn(ProfileRequest, chunk, data.data(), static_cast<uint16_t>(data.size()));
+        if (err < 0)
+            return err;
+        const size_t first = pcs.size();
+        pcs.resize(first + err / sizeof(ProfilePc));
+        memcpy(pcs.data() + first, data.data(), (pcs.size() - first) * sizeof(ProfilePc));
+    }
+    return LIBUSB_SUCCESS;
+}
+
+int Device::readLatency(std::vector<LatencyHist> &histograms)
+{
+    std::vector<uint8_t> data(StatsBufferSize);
+    int err = controlIn(LatencyRequest, 0, data.data(), static_cast<uint16_t>(data.size()));
+    if (err < 0)
+        return err;
+    if (err % sizeof(LatencyHist))
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+
+    histograms.resize(err / sizeof(LatencyHist));
+    memcpy(histograms.data(), data.data(), histograms.size() * sizeof(LatencyHist));
+    for (const LatencyHist &histogram : histograms) {
+        if (histogram.bucketCount != LatencyBuckets)
+            return LIBUSB_ERROR_NOT_SUPPORTED;
+    }
+    return LIBUSB_SUCCESS;
+}
+
+int Device::resetLatency()
+{
+    int err = controlOut(LatencyRequest, 0, nullptr, 0);
+    return (err < 0) ? err : LIBUSB_SUCCESS;
+}
+
+int Device::readTime(TimeSample &sample)
+{
+    int err = controlIn(TimeRequest, 0, &sample, sizeof(sample));
+    if (err < 0)
+        return err;
+    return (err == sizeof(sample)) ? LIBUSB_SUCCESS : LIBUSB_ERROR_IO;
+}
+
+} // namespace fx3link
@@ -0,0 +1,115 @@
+#ifndef FX3DEVICE_H
+#define FX3DEVICE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <libusb.h>
+
+#include "fx3context.h"
+#include "fx3protocol.h"
+
+namespace fx3link {
+
+struct DeviceInfo {
+    uint16_t vid = 0;
+    uint16_t pid = 0;
+    uint16_t bcdUSB = 0;
+    uint16_t bcdDevice = 0;
+    std::string manufacturer;
+    std::string product;
+    std::string serialNumber;
+};
+
+// Opened device with the vendor interface claimed. Move-only; the interface
+// is released and the handle closed on destruction.
+class Device
+{
+public:
+    Device() = default;
+    ~Device();
+
+    Device(Device &&other) noexcept;
+    Device &operator=(Device &&other) noexcept;
+    Device(const Device &) = delete;
+    Device &operator=(const Device &) = delete;
+
+    // Opens the first device matching vid/pid. Returns LIBUSB_ERROR_NOT_FOUND
+    // if there is none.
+    int open(Context &ctx, uint16_t vid = UsbVid, uint16_t pid = UsbPid);
+    void close();
+
+    bool isOpen() const { return m_handle != nullptr; }
+    libusb_device_handle *native() const { return m_handle; }
+    const DeviceInfo &info() const { return m_info; }
+
+    // Negotiated link speed, one of libusb_speed
+    int speed() const;
+
+    // Synchronous vendor requests addressed to the interface. Return the
+    // number of bytes transferred or a negative libusb error code.
+    int controlOut(uint8_t request, uint16_t value, const void *data, uint16_t length,
+                   unsigned timeout = DefaultTimeout);
+    int controlIn(uint8_t request, uint16_t value, void *data, uint16_t length,
+                  unsigned timeout = DefaultTimeout);
+
+    // Sends the configuration and waits until the device applied it, so a
+    // following getStreamStatus reports the new channel. Returns
+    // LIBUSB_ERROR_OTHER if the device could not apply it and
+    // LIBUSB_ERROR_TIMEOUT if it did not finish within timeout ms.
+    int setStreamConfig(const StreamConfig &config, unsigned timeout = DefaultTimeout);
+    int getStreamStatus(StreamStatus &status);
+
+    // Reads a diagnostic stats page, header included
+    int getStatsPage(uint16_t page, std::vector<uint8_t> &data);
+    // Reads the records of a stats page. Returns LIBUSB_ERROR_NOT_SUPPORTED
+    // if the firmware record size does not match Record.
+    template <typename Record>
+    int getStats(uint16_t page, std::vector<Record> &records);
+
+    // Drains up to one request worth of binary log records (oldest first) and
+    // appends them. 'lost' receives the records the device overwrote before
+    // they could be read.
+    int readLog(std::vector<LogRecord> &records, uint32_t &lost);
+
+    // Clears the profiler histograms and samples at rateHz; 0 stops it
+    int startProfile(uint16_t rateHz);
+    // Reads the profiler histograms. Stop the profiler first for a
+    // consistent snapshot.
+    int readProfile(ProfileSummary &summary, std::vector<ProfileThread> &threads, std::vector<ProfilePc> &pcs);
+
+    // Reads the device latency histograms, one per LatencyHist::Id
+    int readLatency(std::vector<LatencyHist> &histograms);
+    // Clears the device latency histograms
+    int resetLatency();
+
+    // Reads the device clock, see ClockSync for pairing it with the host's
+    int readTime(TimeSample &sample);
+
+private:
+    libusb_device_handle *m_handle = nullptr;
+    DeviceInfo m_info;
+};
+
+template <typename Record>
+int Device::getStats(uint16_t page, std::vector<Record> &records)
+{
+    std::vector<uint8_t> data;
+    int err = getStatsPage(page, data);
+    if (err != LIBUSB_SUCCESS)
+        return err;
+
+    StatsHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.recordSize != sizeof(Record))
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+
+    records.resize(header.count);
+    memcpy(records.data(), data.data() + sizeof(header), header.count * sizeof(Record));
+    return LIBUSB_SUCCESS;
+}
+
+} // namespace fx3link
+
+#endif // FX3DEVICE_H
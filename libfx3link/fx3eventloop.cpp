@@ -0,0 +1,90 @@
+#include "fx3eventloop.h"
+
+#include "fx3thread.h"
+
+namespace fx3link {
+
+static constexpr long EventTimeoutUs = 100000;
+
+EventLoop::EventLoop(Context &ctx)
+    : m_ctx(ctx)
+{
+}
+
+EventLoop::EventLoop(Context &ctx, const EventLoopOptions &options)
+    : m_ctx(ctx)
+    , m_options(options)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    stop();
+}
+
+int EventLoop::start()
+{
+    if (isRunning())
+        return LIBUSB_SUCCESS;
+    if (!m_ctx.isValid())
+        return LIBUSB_ERROR_INVALID_PARAM;
+
+    if (m_options.lockMemory) {
+        const int err = lockProcessMemory();
+        if (err != LIBUSB_SUCCESS)
+            return err;
+        m_lockedMemory = true;
+    }
+
+    // The thread applies its own CPU and priority before handling events
+    std::promise<int> setup;
+    std::future<int> result = setup.get_future();
+    __atomic_store_n(&m_stop, 0, __ATOMIC_RELEASE);
+    m_thread = std::thread(&EventLoop::run, this, std::move(setup));
+    m_threadId = m_thread.get_id();
+
+    const int err = result.get();
+    if (err != LIBUSB_SUCCESS) {
+        m_thread.join();
+        m_threadId = std::thread::id();
+        if (m_lockedMemory)
+            unlockProcessMemory();
+        m_lockedMemory = false;
+    }
+    return err;
+}
+
+void EventLoop::stop()
+{
+    if (!isRunning())
+        return;
+
+    __atomic_store_n(&m_stop, 1, __ATOMIC_RELEASE);
+    libusb_interrupt_event_handler(m_ctx.native());
+    m_thread.join();
+    m_threadId = std::thread::id();
+    if (m_lockedMemory)
+        unlockProcessMemory();
+    m_lockedMemory = false;
+}
+
+void EventLoop::run(std::promise<int> setup)
+{
+    int err = LIBUSB_SUCCESS;
+    if (m_options.cpu >= 0)
+        err = pinCurrentThread(m_options.cpu);
+    if ((err == LIBUSB_SUCCESS) && (m_options.realtimePriority > 0))
+        err = setCurrentThreadRealtime(m_options.realtimePriority);
+    setup.set_value(err);
+    if (err != LIBUSB_SUCCESS)
+        return;
+
+    // A zero timeout makes libusb poll the descriptors once and return
+    const long timeoutUs = m_options.busyPoll ? 0 : EventTimeoutUs;
+    while (!__atomic_load_n(&m_stop, __ATOMIC_ACQUIRE)) {
+        struct timeval tv = { 0, timeoutUs };
+        libusb_handle_events_timeout_completed(m_ctx.native(), &tv, &m_stop);
+    }
+}
+
+} // namespace fx3link
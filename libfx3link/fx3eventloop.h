@@ -0,0 +1,59 @@
+#ifndef FX3EVENTLOOP_H
+#define FX3EVENTLOOP_H
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include "fx3context.h"
+
+namespace fx3link {
+
+struct EventLoopOptions {
+    // Polls with a zero timeout instead of sleeping in poll(), which saves
+    // the wakeup on every completion but keeps one core at 100 %
+    bool busyPoll = false;
+    int cpu = -1;                   // -1 = not pinned
+    int realtimePriority = 0;       // SCHED_FIFO 1..99, 0 = normal scheduling
+    bool lockMemory = false;        // mlockall() while the loop runs, see lockProcessMemory()
+};
+
+// Thread running libusb event handling, which is where all asynchronous
+// transfer completions are delivered. The default blocks in libusb for up
+// to 100 ms at a time; see EventLoopOptions for the low-latency setup.
+class EventLoop
+{
+public:
+    explicit EventLoop(Context &ctx);
+    EventLoop(Context &ctx, const EventLoopOptions &options);
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    // Takes effect on the next start()
+    void setOptions(const EventLoopOptions &options) { m_options = options; }
+    const EventLoopOptions &options() const { return m_options; }
+
+    // Fails, with no thread left running, if the CPU, priority or memory
+    // lock cannot be applied
+    int start();
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+    bool isEventThread() const { return std::this_thread::get_id() == m_threadId; }
+
+private:
+    void run(std::promise<int> setup);
+
+    Context &m_ctx;
+    EventLoopOptions m_options;
+    std::thread m_thread;
+    std::thread::id m_threadId;
+    int m_stop = 0;
+    bool m_lockedMemory = false;
+};
+
+} // namespace fx3link
+
+#endif // FX3EVENTLOOP_H
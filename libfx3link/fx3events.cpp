@@ -0,0 +1,114 @@
+#include "fx3events.h"
+
+#include <string.h>
+
+namespace fx3link {
+
+EventListener::EventListener(Device &device)
+    : m_device(device)
+{
+    for (int i = 0; i < Depth; i++)
+        m_transfers[i].setCallback([this](Transfer &t) { complete(t); });
+}
+
+EventListener::~EventListener()
+{
+    stop();
+}
+
+int EventListener::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_inflight > 0)
+        return LIBUSB_ERROR_BUSY;
+
+    m_error = LIBUSB_SUCCESS;
+    m_stopping = false;
+    m_synced = false;
+    m_lost = 0;
+
+    for (int i = 0; i < Depth; i++) {
+        // No timeout, events are rare
+        m_transfers[i].fillInterrupt(m_device, EpEvent, m_buffers[i], sizeof(m_buffers[i]), 0);
+        int err = m_transfers[i].submit();
+        if (err != LIBUSB_SUCCESS) {
+            m_error = err;
+            m_stopping = true;
+            for (int j = 0; j < i; j++)
+                m_transfers[j].cancel();
+            break;
+        }
+        m_inflight++;
+    }
+    return m_error;
+}
+
+void EventListener::stop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_inflight > 0) {
+        m_stopping = true;
+        for (int i = 0; i < Depth; i++)
+            m_transfers[i].cancel();
+        m_drained.wait(lock, [this] { return m_inflight == 0; });
+    }
+}
+
+bool EventListener::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inflight > 0;
+}
+
+int EventListener::error() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+uint32_t EventListener::lost() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lost;
+}
+
+void EventListener::complete(Transfer &transfer)
+{
+    // The transfer counts as in flight until the handler returned, so stop()
+    // never returns under a running handler
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int err = transfer.error();
+    if (err != LIBUSB_SUCCESS) {
+        if (!m_stopping && (m_error == LIBUSB_SUCCESS))
+            m_error = err;
+        m_stopping = true;
+    } else if (transfer.actualLength() == static_cast<int>(sizeof(DeviceEvent))) {
+        DeviceEvent event;
+        memcpy(&event, transfer.buffer(), sizeof(event));
+        if (m_synced)
+            m_lost += static_cast<uint16_t>(event.seq - m_nextSeq);
+        m_synced = true;
+        m_nextSeq = static_cast<uint16_t>(event.seq + 1);
+        if (m_handler) {
+            // The handler may take its time, the other transfer keeps listening
+            lock.unlock();
+            m_handler(event);
+            lock.lock();
+        }
+    }
+
+    if (!m_stopping) {
+        err = transfer.submit();
+        if (err == LIBUSB_SUCCESS)
+            return;
+        if (m_error == LIBUSB_SUCCESS)
+            m_error = err;
+    }
+
+    m_inflight--;
+
+    if (m_inflight == 0)
+        m_drained.notify_all();
+}
+
+} // namespace fx3link
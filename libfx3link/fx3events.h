@@ -0,0 +1,64 @@
+#ifndef FX3EVENTS_H
+#define FX3EVENTS_H
+
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#include "fx3device.h"
+#include "fx3transfer.h"
+
+namespace fx3link {
+
+// Receives the device events from the EP2 IN interrupt endpoint and hands
+// each one to the handler. Two transfers stay queued, so an event never
+// waits for a resubmission. The handler runs on the libusb event thread,
+// so an EventLoop must be running. The device only serves the endpoint
+// while it is configured; events raised before that arrive on the first
+// poll.
+class EventListener
+{
+public:
+    using Handler = std::function<void(const DeviceEvent &event)>;
+
+    explicit EventListener(Device &device);
+    ~EventListener();
+
+    EventListener(const EventListener &) = delete;
+    EventListener &operator=(const EventListener &) = delete;
+
+    void onEvent(Handler handler) { m_handler = std::move(handler); }
+
+    int start();
+    // Cancels the transfers and waits for them to drain
+    void stop();
+
+    bool isRunning() const;
+    int error() const;
+    // Events the device overwrote before the host polled, from the seq gaps
+    uint32_t lost() const;
+
+private:
+    static constexpr int Depth = 2;
+
+    void complete(Transfer &transfer);
+
+    Device &m_device;
+    Handler m_handler;
+    Transfer m_transfers[Depth];
+    uint8_t m_buffers[Depth][sizeof(DeviceEvent)];
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_drained;
+    int m_inflight = 0;
+    int m_error = 0;
+    bool m_stopping = false;
+    bool m_synced = false;
+    uint16_t m_nextSeq = 0;
+    uint32_t m_lost = 0;
+};
+
+} // namespace fx3link
+
+#endif // FX3EVENTS_H
@@ -0,0 +1,27 @@
+#ifndef FX3LINK_H
+#define FX3LINK_H
+
+#include "fx3bufferpool.h"
+#include "fx3clock.h"
+#include "fx3codec.h"
+#include "fx3context.h"
+#include "fx3crc.h"
+#include "fx3device.h"
+#include "fx3eventloop.h"
+#include "fx3events.h"
+#include "fx3log.h"
+#include "fx3pattern.h"
+#include "fx3pipeline.h"
+#include "fx3protocol.h"
+#include "fx3queue.h"
+#include "fx3reconnect.h"
+#include "fx3stream.h"
+#include "fx3thread.h"
+#include "fx3transfer.h"
+
+// Coroutine API, available to C++20 consumers
+#if defined(__cpp_impl_coroutine)
+#include "fx3coro.h"
+#endif
+
+#endif // FX3LINK_H
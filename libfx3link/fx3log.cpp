@@ -0,0 +1,59 @@
+#include "fx3log.h"
+
+#include <stdio.h>
+
+#include "../src/cyfxlogmsg.h"
+
+namespace fx3link {
+
+#define FX3_LOG_FORMAT_ENTRY(id, format) format,
+
+static const char *const logFormats[] = {
+    CY_FX_LOG_MESSAGES(FX3_LOG_FORMAT_ENTRY)
+};
+
+static_assert(sizeof(logFormats) / sizeof(logFormats[0]) == CY_FX_LOG_ID_COUNT,
+              "One format per message ID");
+
+const char *LogDecoder::format(uint16_t id)
+{
+    return (id < CY_FX_LOG_ID_COUNT) ? logFormats[id] : nullptr;
+}
+
+std::string LogDecoder::message(const LogRecord &record)
+{
+    char text[256];
+    const char *fmt = format(record.id);
+    if (fmt) {
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+#endif
+        snprintf(text, sizeof(text), fmt, record.args[0], record.args[1], record.args[2]);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+    } else {
+        snprintf(text, sizeof(text), "Unknown message %u: 0x%08X 0x%08X 0x%08X",
+                 record.id, record.args[0], record.args[1], record.args[2]);
+    }
+    return text;
+}
+
+double LogDecoder::timestamp(const LogRecord &record)
+{
+    if (record.ticks < m_lastTicks)
+        m_high += uint64_t(1) << 32;
+    m_lastTicks = record.ticks;
+    return double(m_high | record.ticks) / TimerHz;
+}
+
+std::string LogDecoder::render(const LogRecord &record)
+{
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "[%12.6f] ", timestamp(record));
+    return prefix + message(record);
+}
+
+} // namespace fx3link
@@ -0,0 +1,37 @@
+#ifndef FX3LOG_H
+#define FX3LOG_H
+
+#include <stdint.h>
+#include <string>
+
+#include "fx3protocol.h"
+
+namespace fx3link {
+
+// Renders the firmware's binary log. The message formats come from the
+// firmware's own table (src/cyfxlogmsg.h), compiled into this library, so
+// the decoder always matches a firmware built from the same tree.
+class LogDecoder
+{
+public:
+    // Format string of a message ID, nullptr if the ID is unknown
+    static const char *format(uint16_t id);
+    // Message text with the arguments filled in
+    static std::string message(const LogRecord &record);
+
+    // Device time of a record in seconds. The 32-bit cycle counter wraps
+    // every ~21 s; records must be fed in order, and gaps longer than one
+    // wrap cannot be detected.
+    double timestamp(const LogRecord &record);
+
+    // "[   12.345678] message"
+    std::string render(const LogRecord &record);
+
+private:
+    uint64_t m_high = 0;
+    uint32_t m_lastTicks = 0;
+};
+
+} // namespace fx3link
+
+#endif // FX3LOG_H
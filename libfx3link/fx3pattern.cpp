@@ -0,0 +1,303 @@
+#include "fx3pattern.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FX3_PATTERN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define FX3_PATTERN_AVX2
+#else
+#define FX3_PATTERN_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace fx3link {
+
+// Word after prev in the Prbs31 sequence, given the word itself for the
+// bits that look back less than 32. Without errors word == prbsNext(prev).
+static inline uint32_t prbsExpected(uint32_t prev, uint32_t word)
+{
+    return (prev >> 1) ^ (prev >> 4) ^ (word << 31) ^ (word << 28);
+}
+
+static inline uint32_t prbsNext(uint32_t prev)
+{
+    const uint32_t x = (prev >> 1) ^ (prev >> 4);
+    return x ^ (x << 28) ^ ((x & 1) << 31);
+}
+
+static inline uint32_t loadWord(const uint8_t *data)
+{
+    uint32_t word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+PatternGenerator::PatternGenerator(Pattern pattern, uint32_t seed)
+    : m_pattern(pattern)
+    , m_seed(seed)
+{
+}
+
+void PatternGenerator::reset()
+{
+    m_word = 0;
+    m_index = 0;
+    m_offset = 0;
+}
+
+uint32_t PatternGenerator::nextWord()
+{
+    switch (m_pattern) {
+    case Pattern::Counter:
+        m_word = m_seed + static_cast<uint32_t>(m_index);
+        break;
+    case Pattern::Constant:
+        m_word = (m_seed & 0xFF) * 0x01010101u;
+        break;
+    case Pattern::Prbs31:
+        // Bit 31 keeps the 31 bits the sequence runs on from being all zero
+        m_word = m_index ? prbsNext(m_word) : (m_seed | 0x80000000u);
+        break;
+    }
+    m_index++;
+    return m_word;
+}
+
+void PatternGenerator::fill(uint8_t *data, size_t size)
+{
+    while (size && m_offset) {
+        *data++ = static_cast<uint8_t>(m_word >> (8 * m_offset));
+        m_offset = (m_offset + 1) & 3;
+        size--;
+    }
+    for (; size >= 4; size -= 4, data += 4) {
+        const uint32_t word = nextWord();
+        memcpy(data, &word, sizeof(word));
+    }
+    if (size) {
+        nextWord();
+        for (; m_offset < size; m_offset++)
+            data[m_offset] = static_cast<uint8_t>(m_word >> (8 * m_offset));
+    }
+}
+
+void PatternChecker::State::mismatch(uint64_t word)
+{
+    if (!errors)
+        firstError = word * 4;
+    errors++;
+}
+
+static size_t checkNone(const uint8_t *, size_t, PatternChecker::State &)
+{
+    return 0;
+}
+
+#if defined(FX3_PATTERN_X86)
+
+// Whole vectors from data up; Prbs31 reads the word before data too. A
+// vector with a bad lane is gone through lane by lane, so the error count
+// and the first offset come at no cost while the data is good.
+template <Pattern P>
+static size_t checkSse2(const uint8_t *data, size_t words, PatternChecker::State &state)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i constant = _mm_set1_epi32(static_cast<int>(state.constant));
+    const __m128i step = _mm_set1_epi32(4);
+    __m128i counter = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(state.counter)), _mm_setr_epi32(0, 1, 2, 3));
+    size_t w = 0;
+
+    for (; w + 4 <= words; w += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 4 * w));
+        __m128i diff;
+        if constexpr (P == Pattern::Counter) {
+            diff = _mm_xor_si128(a, counter);
+            counter = _mm_add_epi32(counter, step);
+        } else if constexpr (P == Pattern::Constant) {
+            diff = _mm_xor_si128(a, constant);
+        } else {
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 4 * w - 4));
+            const __m128i expected = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(b, 1), _mm_srli_epi32(b, 4)),
+                                                   _mm_xor_si128(_mm_slli_epi32(a, 31), _mm_slli_epi32(a, 28)));
+            diff = _mm_or_si128(_mm_xor_si128(a, expected), _mm_cmpeq_epi32(_mm_or_si128(a, b), zero));
+        }
+        const int good = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(diff, zero)));
+        if (good != 0xF) {
+            for (int lane = 0; lane < 4; lane++) {
+                if (!(good & (1 << lane)))
+                    state.mismatch(state.index + w + lane);
+            }
+        }
+    }
+
+    state.index += w;
+    state.counter += static_cast<uint32_t>(w);
+    if (w)
+        state.prev = loadWord(data + 4 * w - 4);
+    return w;
+}
+
+template <Pattern P>
+FX3_PATTERN_AVX2 static size_t checkAvx2(const uint8_t *data, size_t words, PatternChecker::State &state)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i constant = _mm256_set1_epi32(static_cast<int>(state.constant));
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i counter = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(state.counter)),
+                                       _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    size_t w = 0;
+
+    for (; w + 8 <= words; w += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 4 * w));
+        __m256i diff;
+        if constexpr (P == Pattern::Counter) {
+            diff = _mm256_xor_si256(a, counter);
+            counter = _mm256_add_epi32(counter, step);
+        } else if constexpr (P == Pattern::Constant) {
+            diff = _mm256_xor_si256(a, constant);
+        } else {
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 4 * w - 4));
+            const __m256i expected = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi32(b, 1), _mm256_srli_epi32(b, 4)),
+                                                      _mm256_xor_si256(_mm256_slli_epi32(a, 31), _mm256_slli_epi32(a, 28)));
+            diff = _mm256_or_si256(_mm256_xor_si256(a, expected), _mm256_cmpeq_epi32(_mm256_or_si256(a, b), zero));
+        }
+        const int good = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(diff, zero)));
+        if (good != 0xFF) {
+            for (int lane = 0; lane < 8; lane++) {
+                if (!(good & (1 << lane)))
+                    state.mismatch(state.index + w + lane);
+            }
+        }
+    }
+
+    state.index += w;
+    state.counter += static_cast<uint32_t>(w);
+    if (w)
+        state.prev = loadWord(data + 4 * w - 4);
+    return w;
+}
+
+static bool hasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    if (!(info[2] & (1 << 27)) || ((_xgetbv(0) & 6) != 6))  // OSXSAVE, XMM and YMM state enabled
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool avx2()
+{
+    static const bool supported = hasAvx2();
+    return supported;
+}
+
+static PatternChecker::Kernel selectKernel(Pattern pattern)
+{
+    switch (pattern) {
+    case Pattern::Counter:
+        return avx2() ? checkAvx2<Pattern::Counter> : checkSse2<Pattern::Counter>;
+    case Pattern::Prbs31:
+        return avx2() ? checkAvx2<Pattern::Prbs31> : checkSse2<Pattern::Prbs31>;
+    case Pattern::Constant:
+        return avx2() ? checkAvx2<Pattern::Constant> : checkSse2<Pattern::Constant>;
+    }
+    return checkNone;
+}
+
+const char *PatternChecker::simdName()
+{
+    return avx2() ? "AVX2" : "SSE2";
+}
+
+#else
+
+static PatternChecker::Kernel selectKernel(Pattern)
+{
+    return checkNone;
+}
+
+const char *PatternChecker::simdName()
+{
+    return "scalar";
+}
+
+#endif
+
+PatternChecker::PatternChecker(Pattern pattern, uint32_t seed)
+    : m_pattern(pattern)
+    , m_seed(seed)
+    , m_kernel(selectKernel(pattern))
+{
+    reset();
+}
+
+void PatternChecker::reset()
+{
+    m_state.constant = (m_seed & 0xFF) * 0x01010101u;
+    m_state.counter = m_seed;
+    m_state.prev = 0;
+    m_state.index = 0;
+    m_state.errors = 0;
+    m_state.firstError = NoError;
+    m_bytes = 0;
+    m_partialSize = 0;
+}
+
+void PatternChecker::checkWord(uint32_t word)
+{
+    bool bad = false;
+    switch (m_pattern) {
+    case Pattern::Counter:
+        bad = (word != m_state.counter++);
+        break;
+    case Pattern::Constant:
+        bad = (word != m_state.constant);
+        break;
+    case Pattern::Prbs31:
+        // The first word is the seed
+        bad = m_state.index && ((word != prbsExpected(m_state.prev, word)) || !(word | m_state.prev));
+        m_state.prev = word;
+        break;
+    }
+    if (bad)
+        m_state.mismatch(m_state.index);
+    m_state.index++;
+}
+
+void PatternChecker::check(const uint8_t *data, size_t size)
+{
+    m_bytes += size;
+
+    while (m_partialSize && size) {
+        m_partial[m_partialSize++] = *data++;
+        size--;
+        if (m_partialSize == 4) {
+            checkWord(loadWord(m_partial));
+            m_partialSize = 0;
+        }
+    }
+
+    const size_t words = size / 4;
+    size_t w = 0;
+    // The Prbs31 kernels look one word back, into this buffer
+    if ((m_pattern == Pattern::Prbs31) && words)
+        checkWord(loadWord(data + 4 * w++));
+    w += m_kernel(data + 4 * w, words - w, m_state);
+    for (; w < words; w++)
+        checkWord(loadWord(data + 4 * w));
+
+    for (size_t i = 4 * words; i < size; i++)
+        m_partial[m_partialSize++] = data[i];
+}
+
+} // namespace fx3link
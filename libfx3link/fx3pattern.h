@@ -0,0 +1,88 @@
+#ifndef FX3PATTERN_H
+#define FX3PATTERN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace fx3link {
+
+// Test patterns over a byte stream of little-endian 32-bit words. Word k is
+// seed + k for Counter, the low seed byte in every byte for Constant, and
+// for Prbs31 the next 32 bits of x^31 + x^28 + 1 (ITU-T O.150), bit 0
+// first, started from the seed. Transfer boundaries do not matter; both
+// sides carry partial words over to the next call.
+enum class Pattern : uint8_t {
+    Counter,
+    Prbs31,
+    Constant,
+};
+
+class PatternGenerator
+{
+public:
+    explicit PatternGenerator(Pattern pattern = Pattern::Counter, uint32_t seed = 0);
+
+    void reset();
+    void fill(uint8_t *data, size_t size);
+
+private:
+    uint32_t nextWord();
+
+    Pattern m_pattern;
+    uint32_t m_seed;
+    uint32_t m_word = 0;        // Last word generated
+    uint64_t m_index = 0;       // Words generated
+    unsigned m_offset = 0;      // Bytes of m_word already written
+};
+
+// Verifies a stream against a pattern, 32 or 16 bytes per step with AVX2 or
+// SSE2, chosen at run time, word by word otherwise. Counter and Constant
+// compare with the expected words. Prbs31 checks every word against the
+// received bits 28 and 31 before it, so it needs no seed and locks again
+// one word after lost data; a run of 64 zero bits also counts as an error,
+// the all-zero stream would pass otherwise. Not thread-safe.
+class PatternChecker
+{
+public:
+    static constexpr uint64_t NoError = UINT64_MAX;
+
+    explicit PatternChecker(Pattern pattern = Pattern::Counter, uint32_t seed = 0);
+
+    void reset();
+    void check(const uint8_t *data, size_t size);
+
+    uint64_t bytesChecked() const { return m_bytes; }
+    // Words that did not match, and the stream offset of the first one
+    uint64_t errors() const { return m_state.errors; }
+    uint64_t firstError() const { return m_state.firstError; }
+
+    // "AVX2", "SSE2" or "scalar"
+    static const char *simdName();
+
+    struct State {
+        uint32_t constant;
+        uint32_t counter;       // Next Counter word
+        uint32_t prev;          // Last word received
+        uint64_t index;         // Words checked
+        uint64_t errors;
+        uint64_t firstError;
+
+        void mismatch(uint64_t word);
+    };
+    using Kernel = size_t (*)(const uint8_t *data, size_t words, State &state);
+
+private:
+    void checkWord(uint32_t word);
+
+    Pattern m_pattern;
+    uint32_t m_seed;
+    Kernel m_kernel;
+    State m_state;
+    uint64_t m_bytes = 0;
+    uint8_t m_partial[4];
+    unsigned m_partialSize = 0;
+};
+
+} // namespace fx3link
+
+#endif // FX3PATTERN_H
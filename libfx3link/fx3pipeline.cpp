@@ -0,0 +1,231 @@
+#include "fx3pipeline.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <libusb.h>
+
+#include "fx3thread.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define FX3_CPU_RELAX() _mm_pause()
+#else
+#define FX3_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace fx3link {
+
+static constexpr unsigned SpinCount = 2000;     // Pause loops before yielding
+static constexpr unsigned YieldCount = 100;     // Yields before sleeping
+static constexpr auto IdleSleep = std::chrono::microseconds(50);
+static constexpr size_t PacketAlignment = 64;   // Cache line
+
+namespace {
+
+// Waiting for a queue: spin while the other side is likely just busy, then
+// give the core away
+class Backoff
+{
+public:
+    void reset() { m_count = 0; }
+
+    void wait()
+    {
+        if (m_count < SpinCount)
+            FX3_CPU_RELAX();
+        else if (m_count < SpinCount + YieldCount)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(IdleSleep);
+        if (m_count < SpinCount + YieldCount)
+            m_count++;
+    }
+
+private:
+    unsigned m_count = 0;
+};
+
+} // namespace
+
+Pipeline::~Pipeline()
+{
+    stop();
+}
+
+void Pipeline::addStage(const StageOptions &options, StageHandler handler)
+{
+    if (m_running.load(std::memory_order_acquire))
+        return;
+    m_stages.emplace_back(new Stage(options, std::move(handler)));
+}
+
+int Pipeline::start(size_t packetSize, size_t packetCount)
+{
+    if (m_running.load(std::memory_order_acquire))
+        return LIBUSB_ERROR_BUSY;
+    if (m_stages.empty() || !packetSize || !packetCount)
+        return LIBUSB_ERROR_INVALID_PARAM;
+
+    const size_t stride = (packetSize + PacketAlignment - 1) & ~(PacketAlignment - 1);
+    m_memory.reset(new uint8_t[stride * packetCount + PacketAlignment]);
+    uint8_t *base = m_memory.get();
+    base += (PacketAlignment - (reinterpret_cast<uintptr_t>(base) & (PacketAlignment - 1))) & (PacketAlignment - 1);
+
+    m_packets.assign(packetCount, Packet());
+    m_free.reset(new BoundedQueue<Packet *>(packetCount));
+    for (size_t i = 0; i < packetCount; i++) {
+        m_packets[i].data = base + i * stride;
+        m_packets[i].capacity = packetSize;
+        m_free->push(&m_packets[i]);
+    }
+
+    m_offset = 0;
+    m_busy.store(0, std::memory_order_relaxed);
+    m_failed.store(false, std::memory_order_relaxed);
+    m_drops.store(0, std::memory_order_relaxed);
+    for (auto &stage : m_stages) {
+        stage->queue.reset(new BoundedQueue<Packet *>(packetCount));
+        stage->packets.store(0, std::memory_order_relaxed);
+        stage->bytes.store(0, std::memory_order_relaxed);
+        stage->busyNs.store(0, std::memory_order_relaxed);
+        stage->peakDepth.store(0, std::memory_order_relaxed);
+    }
+    m_running.store(true, std::memory_order_release);
+
+    for (size_t s = 0; s < m_stages.size(); s++) {
+        const unsigned workers = std::max(m_stages[s]->options.workers, 1u);
+        for (unsigned w = 0; w < workers; w++)
+            m_stages[s]->threads.emplace_back(&Pipeline::run, this, s, w);
+    }
+    m_accepting.store(true, std::memory_order_release);
+    return LIBUSB_SUCCESS;
+}
+
+void Pipeline::stop()
+{
+    if (!m_running.load(std::memory_order_acquire))
+        return;
+
+    // A push() racing this either is counted in m_busy before the flag is
+    // cleared, and is waited for, or sees the flag and backs out. Workers
+    // still pass packets on after a failure, they only skip the handlers.
+    m_accepting.store(false, std::memory_order_seq_cst);
+    Backoff backoff;
+    while (m_busy.load(std::memory_order_seq_cst) != 0)
+        backoff.wait();
+
+    m_running.store(false, std::memory_order_release);
+    for (auto &stage : m_stages) {
+        for (auto &thread : stage->threads)
+            thread.join();
+        stage->threads.clear();
+    }
+}
+
+int Pipeline::push(const uint8_t *data, size_t size, uint32_t sequence)
+{
+    if (m_failed.load(std::memory_order_acquire) || !m_accepting.load(std::memory_order_acquire))
+        return LIBUSB_ERROR_OTHER;
+    if (size > m_packets.front().capacity) {
+        m_failed.store(true, std::memory_order_release);
+        return LIBUSB_ERROR_OTHER;
+    }
+
+    // Counted before the second look at the flag, see stop()
+    m_busy.fetch_add(1, std::memory_order_seq_cst);
+    if (!m_accepting.load(std::memory_order_seq_cst)) {
+        m_busy.fetch_sub(1, std::memory_order_acq_rel);
+        return LIBUSB_ERROR_OTHER;
+    }
+
+    // Later packets keep their stream offsets
+    Packet *packet;
+    if (!m_free->pop(packet)) {
+        m_busy.fetch_sub(1, std::memory_order_acq_rel);
+        m_drops.fetch_add(1, std::memory_order_relaxed);
+        m_offset += size;
+        return LIBUSB_ERROR_BUSY;
+    }
+
+    memcpy(packet->data, data, size);
+    packet->size = size;
+    packet->sequence = sequence;
+    packet->offset = m_offset;
+    m_offset += size;
+    forward(SIZE_MAX, packet);
+    return LIBUSB_SUCCESS;
+}
+
+// Hands the packet to the stage after index, SIZE_MAX for the first one,
+// or back to the pool after the last
+void Pipeline::forward(size_t index, Packet *packet)
+{
+    const size_t next = index + 1;
+    if (next == m_stages.size()) {
+        m_free->push(packet);
+        m_busy.fetch_sub(1, std::memory_order_acq_rel);
+        return;
+    }
+
+    // Never full: the queue holds every packet
+    Stage &stage = *m_stages[next];
+    stage.queue->push(packet);
+
+    const size_t depth = stage.queue->size();
+    size_t peak = stage.peakDepth.load(std::memory_order_relaxed);
+    while ((depth > peak) && !stage.peakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {
+    }
+}
+
+void Pipeline::run(size_t index, unsigned worker)
+{
+    Stage &stage = *m_stages[index];
+    if (stage.options.cpu >= 0)
+        pinCurrentThread(stage.options.cpu + static_cast<int>(worker));
+
+    Backoff backoff;
+    for (;;) {
+        Packet *packet;
+        if (!stage.queue->pop(packet)) {
+            if (!m_running.load(std::memory_order_acquire))
+                break;
+            backoff.wait();
+            continue;
+        }
+        backoff.reset();
+
+        if (!m_failed.load(std::memory_order_relaxed)) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = stage.handler(*packet);
+            const auto busy = std::chrono::steady_clock::now() - start;
+            stage.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+                                   std::memory_order_relaxed);
+            stage.packets.fetch_add(1, std::memory_order_relaxed);
+            stage.bytes.fetch_add(packet->size, std::memory_order_relaxed);
+            if (!ok)
+                m_failed.store(true, std::memory_order_release);
+        }
+        forward(index, packet);
+    }
+}
+
+std::vector<StageStats> Pipeline::stats() const
+{
+    std::vector<StageStats> result;
+    for (const auto &stage : m_stages) {
+        StageStats stats;
+        stats.name = stage->options.name;
+        stats.workers = std::max(stage->options.workers, 1u);
+        stats.packets = stage->packets.load(std::memory_order_relaxed);
+        stats.bytes = stage->bytes.load(std::memory_order_relaxed);
+        stats.busyNs = stage->busyNs.load(std::memory_order_relaxed);
+        stats.queueDepth = stage->queue ? stage->queue->size() : 0;
+        stats.peakDepth = stage->peakDepth.load(std::memory_order_relaxed);
+        stats.queueCapacity = stage->queue ? stage->queue->capacity() : 0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+} // namespace fx3link
@@ -0,0 +1,122 @@
+#ifndef FX3PIPELINE_H
+#define FX3PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fx3queue.h"
+
+namespace fx3link {
+
+// One received IN transfer on its way through a Pipeline
+struct Packet {
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    uint32_t sequence;      // Stream sequence of the transfer
+    uint64_t offset;        // Stream bytes in front of it
+};
+
+struct StageOptions {
+    std::string name;
+    unsigned workers = 1;   // More than one hands packets on out of order
+    int cpu = -1;           // Worker i pinned to cpu + i, -1 = not pinned
+};
+
+struct StageStats {
+    std::string name;
+    unsigned workers;
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t busyNs;        // Summed over the workers, time inside the handler
+    size_t queueDepth;      // Packets waiting right now
+    size_t peakDepth;
+    size_t queueCapacity;   // Every packet fits, see Pipeline
+};
+
+// Processing stages behind the libusb receive path. push() runs on the
+// event thread from the Stream data handler: it copies the transfer into a
+// free packet and hands it to the first stage, so the transfer goes back
+// to USB at once and no stage ever touches libusb. Every stage has its own
+// worker threads and a bounded lock-free queue in front; the packet goes
+// back to the pool after the last stage.
+//
+// push() never waits, since anything that blocks the event thread stalls
+// every libusb completion, not just this endpoint. With no free packet it
+// drops the data and counts it; size packetCount for the longest stall of
+// the stages. Each queue holds all packets, so handing a packet on never
+// waits either. Workers spin briefly on an empty queue, then yield and
+// sleep.
+class Pipeline
+{
+public:
+    // Processes a packet in place, returns false to fail the pipeline
+    using StageHandler = std::function<bool(Packet &packet)>;
+
+    Pipeline() = default;
+    ~Pipeline();
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    // Before start(), in processing order
+    void addStage(const StageOptions &options, StageHandler handler);
+
+    // packetSize at least the IN transfer size
+    int start(size_t packetSize, size_t packetCount);
+    // Lets the packets pushed so far run through, then joins the workers.
+    // A push() racing it either gets its packet through or fails.
+    void stop();
+
+    // LIBUSB_SUCCESS, LIBUSB_ERROR_BUSY if no packet was free and the data
+    // was dropped, LIBUSB_ERROR_OTHER once the pipeline failed or stopped.
+    // Data beyond packetSize fails the pipeline.
+    int push(const uint8_t *data, size_t size, uint32_t sequence);
+
+    bool hasFailed() const { return m_failed.load(std::memory_order_acquire); }
+    // push() calls that found no free packet
+    uint64_t drops() const { return m_drops.load(std::memory_order_relaxed); }
+    std::vector<StageStats> stats() const;
+
+private:
+    struct Stage {
+        Stage(const StageOptions &options, StageHandler handler)
+            : options(options)
+            , handler(std::move(handler))
+        {
+        }
+
+        StageOptions options;
+        StageHandler handler;
+        std::unique_ptr<BoundedQueue<Packet *>> queue;     // Created by start()
+        std::vector<std::thread> threads;
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<size_t> peakDepth{0};
+    };
+
+    void run(size_t index, unsigned worker);
+    void forward(size_t index, Packet *packet);
+
+    std::vector<std::unique_ptr<Stage>> m_stages;
+    std::vector<Packet> m_packets;
+    std::unique_ptr<uint8_t[]> m_memory;
+    std::unique_ptr<BoundedQueue<Packet *>> m_free;
+    uint64_t m_offset = 0;
+    std::atomic<size_t> m_busy{0};      // Packets out of the free queue, and push() calls under way
+    std::atomic<bool> m_accepting{false};   // push() may take packets, cleared first by stop()
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_failed{false};
+    std::atomic<uint64_t> m_drops{0};
+};
+
+} // namespace fx3link
+
+#endif // FX3PIPELINE_H
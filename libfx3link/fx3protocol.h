@@ -0,0 +1,319 @@
+#ifndef FX3PROTOCOL_H
+#define FX3PROTOCOL_H
+
+#include <stdint.h>
+
+// Constants and wire structures shared with the firmware (see src/cyfxusb.h
+// and src/cyfxapplication.h). All multi-byte fields are little-endian.
+
+namespace fx3link {
+
+constexpr uint16_t UsbVid               = 0x04B4;
+constexpr uint16_t UsbPid               = 0x0101;
+constexpr int      Interface            = 0;
+constexpr uint8_t  EpProducer           = 0x01; // EP 1 OUT
+constexpr uint8_t  EpConsumer           = 0x81; // EP 1 IN
+constexpr uint8_t  EpEvent              = 0x82; // EP 2 IN, interrupt, one DeviceEvent per packet
+constexpr uint8_t  VendorRequest        = 0xFF; // EP0 echo
+constexpr uint8_t  StreamRequest        = 0xFE; // Stream configuration
+constexpr uint8_t  StatsRequest         = 0xFD; // Diagnostic stats pages
+constexpr uint8_t  LogRequest           = 0xFC; // Binary log read, see fx3log.h
+constexpr uint8_t  ProfileRequest       = 0xFB; // Sampling profiler control and dump
+constexpr uint8_t  LatencyRequest       = 0xFA; // Latency histograms read and reset
+constexpr uint8_t  TimeRequest          = 0xF9; // Device clock sample
+constexpr unsigned DefaultTimeout       = 1000; // ms
+constexpr size_t   BulkBufferSize       = 8192; // CY_FX_BULK_BUFFER_SIZE, largest device buffer
+constexpr uint16_t BulkBufferCountAuto  = 0;    // Device picks the buffer count for the link speed
+constexpr uint16_t StatsBufferSize      = 512;  // CY_FX_STATS_BUFFER_SIZE
+constexpr uint16_t LogBufferSize        = 512;  // Most bytes one log read returns
+constexpr uint32_t TimerHz              = 201600000; // CY_FX_TIMER_HZ, device cycle counter
+constexpr size_t   LatencyBuckets       = 24;   // CY_FX_LATENCY_BUCKETS
+constexpr size_t   BufferHeaderSize     = 16;   // CY_FX_BUFFER_HEADER_SIZE
+constexpr size_t   CrcTrailerSize       = 4;    // CY_FX_CRC_SIZE, CRC-32C, see fx3crc.h
+constexpr size_t   FrameTrailerSize     = 4;    // CY_FX_FRAME_TRAILER_SIZE, see fx3codec.h
+
+// StreamConfig::flags (CY_FX_STREAM_FLAG_*)
+constexpr uint32_t StreamFlagTimestamp  = 0x00000001; // BufferHeader in front of every EP1 IN buffer
+constexpr uint32_t StreamFlagCredit     = 0x00000002; // DeviceEvent::Credit for the EP1 OUT room
+constexpr uint32_t StreamFlagCrc        = 0x00000004; // CRC trailer behind every stamped IN buffer, needs StreamFlagTimestamp
+constexpr uint32_t StreamFlagCrcCheck   = 0x00000008; // Every EP1 OUT buffer ends with a CRC trailer
+constexpr uint32_t StreamFlagRle        = 0x00000010; // Run-length encoded IN frames, needs StreamFlagTimestamp
+constexpr uint32_t StreamFlagDelta16    = 0x00000020; // 16-bit sample deltas, before RLE if both are set
+
+// Stats pages (CY_FX_STATS_PAGE_*)
+constexpr uint16_t StatsPageMemPool     = 0;    // MemPoolStats records
+constexpr uint16_t StatsPageDmaArena    = 1;    // One DmaArenaStats record
+constexpr uint16_t StatsPageMemCheck    = 2;    // MemCheckStats records, driver heap then buffer heap
+constexpr uint16_t StatsPageMemMap      = 3;    // One MemMap record
+constexpr uint16_t StatsPageCbTime      = 4;    // CbTimeStats records, setup then event callback
+constexpr uint16_t StatsPageTimeline    = 5;    // TimelineMark records, one per boot stage
+constexpr uint16_t StatsPageThreads     = 6;    // ThreadStats records, idle row (empty name) last
+constexpr uint16_t StatsPageCrc         = 7;    // One CrcStats record
+constexpr uint16_t StatsPageCodec       = 8;    // One CodecStats record
+
+#pragma pack(push, 1)
+// CyFxStreamConfig_t
+struct StreamConfig {
+    uint32_t flags = 0;
+    uint16_t bufferCount = BulkBufferCountAuto;
+    uint16_t flushTimeoutUs = 0;    // Send partial bulk buffers after this idle time, 0 = never, else >= 50
+    uint32_t sequence = 0;
+};
+
+// CyFxBufferHeader_t, starts every device buffer with StreamFlagTimestamp.
+// An IN transfer usually holds one buffer; a flushed buffer that fills whole
+// packets is followed by the next one in the same transfer. With
+// StreamFlagRle or StreamFlagDelta16 the payload is a frame ending with a
+// FrameTrailer. With StreamFlagCrc the CRC of header and payload follows
+// the payload.
+struct BufferHeader {
+    uint32_t sequence;      // Buffers since the device channel started
+    uint32_t length;        // Payload bytes following the header
+    uint32_t ticksLo;       // 64-bit TimerHz device clock when the buffer was full
+    uint32_t ticksHi;
+
+    uint64_t ticks() const { return (uint64_t(ticksHi) << 32) | ticksLo; }
+};
+
+// CyFxStreamStatus_t
+struct StreamStatus {
+    StreamConfig config;
+    uint8_t isActive;
+    uint8_t usbSpeed;
+    uint16_t resetCount;
+    uint32_t flushCount;    // Partial buffers sent by the flush timer
+    uint16_t bufferSize;    // Device bulk buffers in use, 0 while not active
+    uint16_t bufferCount;
+    uint16_t configCount;   // Configurations the device applied or rejected since power on
+    uint16_t configStatus;  // Device status code of the last one, 0 = applied
+};
+
+// CyFxTimeSample_t, the TimeRequest reply
+struct TimeSample {
+    uint32_t ticksLo;       // 64-bit device clock on entry to the setup callback
+    uint32_t ticksHi;
+    uint32_t timerHz;       // Nominal rate, TimerHz
+
+    uint64_t ticks() const { return (uint64_t(ticksHi) << 32) | ticksLo; }
+};
+
+// CyFxStatsHeader_t, starts every stats page
+struct StatsHeader {
+    uint8_t page;
+    uint8_t count;
+    uint16_t recordSize;
+};
+
+// CyFxMemPoolStats_t
+struct MemPoolStats {
+    uint16_t blockSize;
+    uint16_t blockCount;
+    uint16_t inUse;
+    uint16_t peak;
+    uint32_t allocCount;
+    uint32_t failCount;
+};
+
+// CyFxDmaArenaStats_t
+struct DmaArenaStats {
+    uint32_t baseAddr;
+    uint16_t slotSize;
+    uint8_t slotCount;
+    uint8_t inUse;
+    uint8_t peak;
+    uint8_t reserved[3];
+    uint32_t allocCount;
+    uint32_t fallbackCount;
+};
+
+// CyFxMemCheckStats_t
+struct MemCheckStats {
+    uint32_t stepCount;
+    uint32_t blockCount;
+    uint32_t passCount;
+    uint32_t errorCount;
+    uint16_t maxStepBlocks;
+    uint16_t listLength;
+};
+
+// CyFxMemMap_t
+struct MemMap {
+    uint32_t profile;
+    uint32_t memHeapBase;
+    uint32_t memHeapSize;
+    uint32_t bufferHeapBase;
+    uint32_t bufferHeapSize;
+    uint32_t sysMemTop;
+    uint32_t arenaBase;
+    uint32_t arenaSlotSize;
+    uint32_t arenaSlots;
+    uint32_t bufferMgrSize;
+};
+
+// CyFxCbTimeStats_t, times in TimerHz ticks
+struct CbTimeStats {
+    uint16_t id;
+    uint16_t flags;         // Bit 0: callback runs from the I-TCM
+    uint32_t count;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint32_t totalTicksLo;
+    uint32_t totalTicksHi;
+
+    uint64_t totalTicks() const { return (uint64_t(totalTicksHi) << 32) | totalTicksLo; }
+};
+
+// CyFxTimelineMark_t
+struct TimelineMark {
+    enum Flags : uint16_t {
+        Reached = 0x0001,
+        Timed   = 0x0002,   // ticks is valid, counted from the device's GPIO init
+    };
+    uint16_t stage;         // CyFxTimelineStage_t
+    uint16_t flags;
+    uint32_t ticks;
+};
+
+// CyFxLogHeader_t, starts every log read
+struct LogHeader {
+    uint32_t lost;          // Records overwritten on the device since the previous read
+    uint16_t count;
+    uint16_t recordSize;
+};
+
+// CyFxLogRecord_t
+struct LogRecord {
+    uint16_t id;            // CyFxLogId_t
+    uint16_t seq;
+    uint32_t ticks;         // TimerHz device cycle counter
+    uint32_t args[3];
+};
+
+// CyFxThreadStats_t
+struct ThreadStats {
+    char name[20];
+    uint32_t runTimeUs;     // Sampled, wraps; diff two reads for the load
+    uint32_t stackSize;     // 0 if the device does not paint this stack
+    uint32_t stackUsed;
+};
+
+// CyFxLatencyHist_t. Bucket i holds 2^i .. 2^(i+1) - 1 ticks, the last
+// bucket everything above.
+struct LatencyHist {
+    enum Id : uint16_t {
+        Ep0 = 0,            // Setup callback entry to data sent, ACK or stall
+        Dma = 1,            // Bulk buffer produced by EP1 OUT to consumed by EP1 IN
+    };
+    uint16_t id;
+    uint16_t bucketCount;
+    uint32_t count;
+    uint32_t maxTicks;
+    uint32_t buckets[LatencyBuckets];
+};
+
+// CyFxEventRecord_t, sent on EpEvent
+struct DeviceEvent {
+    enum Type : uint16_t {
+        StreamStart = 1,    // arg0 = bulk buffer count, arg1 = USB speed
+        StreamStop  = 2,
+        Overrun     = 3,    // All bulk buffers full; arg0 = occurrences, arg1 = buffer count
+        DmaError    = 4,    // arg0 = 0; header commit failed, arg0 = 1, arg1 = sequence
+        Counter     = 5,    // arg0 = Counter, arg1 = value; sent at 1, 2, 4, ... x the first threshold
+        Credit      = 6,    // arg0 = EP1 OUT bytes freed since the channel started (wraps), arg1 = capacity
+    };
+    enum Counter : uint32_t {
+        WorkerDrop  = 0,
+        MemCorrupt  = 1,
+        OverrunCount = 2,
+        CrcError    = 3,
+    };
+    uint16_t type;
+    uint16_t seq;           // Gaps are events the device overwrote
+    uint32_t ticks;         // TimerHz device cycle counter
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+// CyFxCrcStats_t
+struct CrcStats {
+    uint32_t benchBytes;    // 0 if the device benchmark did not run
+    uint32_t sliceTicks;    // TimerHz ticks for benchBytes, slice-by-8
+    uint32_t bitwiseTicks;  // The same bytes one bit at a time
+    uint32_t checked;       // EP1 OUT buffers whose trailer was checked
+    uint32_t errors;        // ... and did not match
+    uint32_t appended;      // EP1 IN buffers given a trailer
+};
+
+// CyFxFrameTrailer_t, the last bytes of a compressed payload
+struct FrameTrailer {
+    enum Codec : uint8_t {
+        Stored      = 0,    // Payload as sent
+        Rle         = 1,
+        Delta16     = 2,    // Applied before Rle if both are set
+    };
+    uint16_t rawLength;     // Payload bytes before encoding
+    uint8_t codec;          // Codec bits
+    uint8_t reserved;
+};
+
+// CyFxCodecStats_t, all counters wrap; diff two reads
+struct CodecStats {
+    uint32_t frames;
+    uint32_t storedFrames;  // Frames that did not shrink
+    uint32_t rawBytes;
+    uint32_t frameBytes;    // Trailers included
+    uint32_t ticks;         // TimerHz ticks spent encoding
+    uint32_t maxTicks;      // Longest frame, since boot
+};
+
+// CyFxProfileSummary_t
+struct ProfileSummary {
+    uint32_t samples;
+    uint32_t idle;
+    uint32_t missed;
+    uint32_t unknownPc;
+    uint32_t pcOverflow;
+    uint16_t rateHz;
+    uint8_t threadCount;
+    uint8_t pcChunks;
+};
+
+// CyFxProfileThread_t
+struct ProfileThread {
+    char name[20];
+    uint32_t count;
+};
+
+// CyFxProfilePc_t
+struct ProfilePc {
+    uint32_t pc;
+    uint32_t count;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StreamConfig) == 12, "StreamConfig must match CyFxStreamConfig_t");
+static_assert(sizeof(StreamStatus) == 28, "StreamStatus must match CyFxStreamStatus_t");
+static_assert(sizeof(BufferHeader) == BufferHeaderSize, "BufferHeader must match CyFxBufferHeader_t");
+static_assert(sizeof(TimeSample) == 12, "TimeSample must match CyFxTimeSample_t");
+static_assert(sizeof(StatsHeader) == 4, "StatsHeader must match CyFxStatsHeader_t");
+static_assert(sizeof(MemPoolStats) == 16, "MemPoolStats must match CyFxMemPoolStats_t");
+static_assert(sizeof(DmaArenaStats) == 20, "DmaArenaStats must match CyFxDmaArenaStats_t");
+static_assert(sizeof(MemCheckStats) == 20, "MemCheckStats must match CyFxMemCheckStats_t");
+static_assert(sizeof(MemMap) == 40, "MemMap must match CyFxMemMap_t");
+static_assert(sizeof(CbTimeStats) == 24, "CbTimeStats must match CyFxCbTimeStats_t");
+static_assert(sizeof(TimelineMark) == 8, "TimelineMark must match CyFxTimelineMark_t");
+static_assert(sizeof(LogHeader) == 8, "LogHeader must match CyFxLogHeader_t");
+static_assert(sizeof(LogRecord) == 20, "LogRecord must match CyFxLogRecord_t");
+static_assert(sizeof(ThreadStats) == 32, "ThreadStats must match CyFxThreadStats_t");
+static_assert(sizeof(LatencyHist) == 108, "LatencyHist must match CyFxLatencyHist_t");
+static_assert(sizeof(DeviceEvent) == 16, "DeviceEvent must match CyFxEventRecord_t");
+static_assert(sizeof(CrcStats) == 24, "CrcStats must match CyFxCrcStats_t");
+static_assert(sizeof(FrameTrailer) == FrameTrailerSize, "FrameTrailer must match CyFxFrameTrailer_t");
+static_assert(sizeof(CodecStats) == 24, "CodecStats must match CyFxCodecStats_t");
+static_assert(sizeof(ProfileSummary) == 24, "ProfileSummary must match CyFxProfileSummary_t");
+static_assert(sizeof(ProfileThread) == 24, "ProfileThread must match CyFxProfileThread_t");
+static_assert(sizeof(ProfilePc) == 8, "ProfilePc must match CyFxProfilePc_t");
+
+} // namespace fx3link
+
+#endif // FX3PROTOCOL_H
@@ -0,0 +1,110 @@
+#include "fx3reconnect.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace fx3link {
+
+static constexpr std::chrono::milliseconds PollInterval{50};
+
+ReconnectSupervisor::ReconnectSupervisor(Context &ctx, uint16_t vid, uint16_t pid)
+    : m_ctx(ctx), m_vid(vid), m_pid(pid)
+{
+    if (libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG))
+        m_hasHotplug = (libusb_hotplug_register_callback(m_ctx.native(), LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED,
+                                                         LIBUSB_HOTPLUG_NO_FLAGS, m_vid, m_pid,
+                                                         LIBUSB_HOTPLUG_MATCH_ANY, hotplugCallback, this,
+                                                         &m_hotplugHandle) == LIBUSB_SUCCESS);
+}
+
+ReconnectSupervisor::~ReconnectSupervisor()
+{
+    if (m_hasHotplug)
+        libusb_hotplug_deregister_callback(m_ctx.native(), m_hotplugHandle);
+}
+
+bool ReconnectSupervisor::isReconnectable(int error)
+{
+    switch (error) {
+    case LIBUSB_ERROR_IO:
+    case LIBUSB_ERROR_NO_DEVICE:
+    case LIBUSB_ERROR_PIPE:
+    case LIBUSB_ERROR_TIMEOUT:
+    case LIBUSB_ERROR_NOT_FOUND:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int ReconnectSupervisor::reconnect(Device &device, const StreamConfig &config)
+{
+    const auto lost = std::chrono::steady_clock::now();
+    const auto deadline = lost + m_timeout;
+    int err = LIBUSB_ERROR_NOT_FOUND;
+
+    // Cleared first, an arrival right after the close must not be missed
+    m_arrived.store(false);
+    device.close();
+
+    for (;;) {
+        // A timeout or a stall often leaves the device enumerated, so try
+        // right away. The device node may not be accessible right after an
+        // arrival either, so keep trying.
+        err = device.open(m_ctx, m_vid, m_pid);
+        if (err == LIBUSB_SUCCESS) {
+            err = device.setStreamConfig(config);
+            if (err == LIBUSB_SUCCESS)
+                break;
+            device.close();
+            if (!isReconnectable(err))
+                return err;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+        waitForArrival(std::min(now + PollInterval, deadline));
+    }
+
+    if (err != LIBUSB_SUCCESS)
+        return err;
+
+    const auto downtime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - lost);
+    m_stats.count++;
+    m_stats.last = downtime;
+    m_stats.total += downtime;
+    if (downtime > m_stats.max)
+        m_stats.max = downtime;
+    return LIBUSB_SUCCESS;
+}
+
+// Hotplug only cuts the poll interval short
+void ReconnectSupervisor::waitForArrival(std::chrono::steady_clock::time_point until)
+{
+    if (!m_hasHotplug) {
+        std::this_thread::sleep_until(until);
+        return;
+    }
+
+    while (!m_arrived.exchange(false)) {
+        const auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+                    until - std::chrono::steady_clock::now());
+        if (left.count() <= 0)
+            return;
+        // Harmless if an EventLoop is handling events at the same time
+        struct timeval tv = { static_cast<long>(left.count() / 1000000), static_cast<long>(left.count() % 1000000) };
+        libusb_handle_events_timeout_completed(m_ctx.native(), &tv, nullptr);
+    }
+}
+
+int LIBUSB_CALL ReconnectSupervisor::hotplugCallback(libusb_context *, libusb_device *,
+                                                     libusb_hotplug_event event, void *userData)
+{
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED)
+        static_cast<ReconnectSupervisor *>(userData)->m_arrived.store(true);
+    return 0;
+}
+
+} // namespace fx3link
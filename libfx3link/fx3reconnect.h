@@ -0,0 +1,66 @@
+#ifndef FX3RECONNECT_H
+#define FX3RECONNECT_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+#include "fx3context.h"
+#include "fx3device.h"
+#include "fx3protocol.h"
+
+namespace fx3link {
+
+struct ReconnectStats {
+    unsigned count = 0;
+    std::chrono::milliseconds last{0};
+    std::chrono::milliseconds max{0};
+    std::chrono::milliseconds total{0};
+};
+
+// Brings a device back after a cable glitch or bus reset: reopens it,
+// reclaims the interface and restores the stream configuration. It tries
+// at once, since a timeout or stall does not always re-enumerate the
+// device, and then every poll interval; hotplug, where libusb supports it,
+// wakes it early when the device arrives.
+// The downtime is bounded by the timeout and recorded in stats().
+class ReconnectSupervisor
+{
+public:
+    explicit ReconnectSupervisor(Context &ctx, uint16_t vid = UsbVid, uint16_t pid = UsbPid);
+    ~ReconnectSupervisor();
+
+    ReconnectSupervisor(const ReconnectSupervisor &) = delete;
+    ReconnectSupervisor &operator=(const ReconnectSupervisor &) = delete;
+
+    void setTimeout(std::chrono::milliseconds timeout) { m_timeout = timeout; }
+    std::chrono::milliseconds timeout() const { return m_timeout; }
+    bool hasHotplug() const { return m_hasHotplug; }
+    const ReconnectStats &stats() const { return m_stats; }
+
+    // Errors after which the device is expected to come back. A Stream
+    // failed by its data handler (Stream::dataRejected) is not one of them.
+    static bool isReconnectable(int error);
+
+    // Closes the device, waits for it and reopens it with the given stream
+    // configuration. The caller must have stopped all transfers on it.
+    int reconnect(Device &device, const StreamConfig &config);
+
+private:
+    void waitForArrival(std::chrono::steady_clock::time_point until);
+    static int LIBUSB_CALL hotplugCallback(libusb_context *ctx, libusb_device *device,
+                                           libusb_hotplug_event event, void *userData);
+
+    Context &m_ctx;
+    uint16_t m_vid;
+    uint16_t m_pid;
+    std::chrono::milliseconds m_timeout{5000};
+    bool m_hasHotplug = false;
+    libusb_hotplug_callback_handle m_hotplugHandle = 0;
+    std::atomic<bool> m_arrived{false};
+    ReconnectStats m_stats;
+};
+
+} // namespace fx3link
+
+#endif // FX3RECONNECT_H
@@ -0,0 +1,283 @@
+#include "fx3stream.h"
+
+#include <algorithm>
+
+namespace fx3link {
+
+StreamOptions StreamOptions::forSpeed(int speed)
+{
+    StreamOptions options;
+    if (speed >= LIBUSB_SPEED_SUPER) {
+        options.transferSize = 8 * BulkBufferSize;
+        options.queueDepth = 8;
+    } else {
+        options.transferSize = 2 * BulkBufferSize;
+        options.queueDepth = 4;
+    }
+    return options;
+}
+
+Stream::Stream(Device &device)
+    : m_device(device)
+{
+}
+
+Stream::~Stream()
+{
+    stop();
+}
+
+int Stream::start(uint32_t sequence)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_inflight > 0)
+        return LIBUSB_ERROR_BUSY;
+
+    m_slots.clear();
+    int err = m_pool.init(&m_device, std::max(m_options.transferSize, inTransferSize()),
+                          m_options.queueDepth * (m_options.loopback ? 2 : 1));
+    if (err != LIBUSB_SUCCESS)
+        return err;
+
+    m_error = LIBUSB_SUCCESS;
+    m_dataRejected = false;
+    m_stopping = false;
+    m_ended = false;
+    m_outSequence = sequence;
+    m_inSequence.store(sequence, std::memory_order_release);
+    m_bytesIn.store(0, std::memory_order_relaxed);
+    m_bytesOut.store(0, std::memory_order_relaxed);
+    m_shortIn.store(0, std::memory_order_relaxed);
+    m_creditWaits.store(0, std::memory_order_relaxed);
+    m_creditQueue.clear();
+    m_creditSent = 0;
+
+    for (unsigned i = 0; i < m_options.queueDepth; i++) {
+        std::unique_ptr<Slot> slot(new Slot);
+        Slot *s = slot.get();
+        s->in.setCallback([this, s](Transfer &t) { complete(*s, t, true); });
+        s->inBuffer = m_pool.acquire();
+        if (m_options.loopback) {
+            s->out.setCallback([this, s](Transfer &t) { complete(*s, t, false); });
+            s->outBuffer = m_pool.acquire();
+        }
+        m_slots.push_back(std::move(slot));
+    }
+
+    for (auto &slot : m_slots) {
+        if (!submitSlot(*slot))
+            break;
+    }
+
+    if ((m_inflight == 0) && (m_error == LIBUSB_SUCCESS))
+        m_ended = true;
+    return m_error;
+}
+
+void Stream::stop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_inflight > 0) {
+        m_stopping = true;
+        dropCreditQueue();
+        for (auto &slot : m_slots) {
+            slot->in.cancel();
+            slot->out.cancel();
+        }
+        m_drained.wait(lock, [this] { return m_inflight == 0; });
+    }
+    release();
+}
+
+int Stream::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_drained.wait(lock, [this] { return m_inflight == 0; });
+    return m_error;
+}
+
+bool Stream::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inflight > 0;
+}
+
+int Stream::error() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+bool Stream::dataRejected() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dataRejected;
+}
+
+// Called with m_mutex held
+bool Stream::submitSlot(Slot &slot)
+{
+    if (m_stopping || m_ended)
+        return false;
+
+    size_t size = m_options.transferSize;
+    if (m_options.loopback) {
+        size = m_fill ? m_fill(slot.outBuffer, m_options.transferSize, m_outSequence) : 0;
+        if (size == 0) {
+            m_ended = true;
+            return false;
+        }
+        slot.out.fillBulk(m_device, EpProducer, slot.outBuffer, static_cast<int>(size), m_options.timeout);
+    }
+
+    // Queue IN first, so the looped back data always has a transfer waiting
+    slot.in.fillBulk(m_device, EpConsumer, slot.inBuffer, static_cast<int>(inTransferSize()), m_options.timeout);
+    int err = slot.in.submit();
+    if (err != LIBUSB_SUCCESS) {
+        fail(err);
+        return false;
+    }
+    slot.pending++;
+    m_inflight++;
+
+    if (m_options.loopback) {
+        m_outSequence++;
+        slot.outSize = size;
+        if (m_options.creditFlow && (!m_creditQueue.empty() || !hasCredit(size))) {
+            slot.outQueued = true;
+            m_creditQueue.push_back(&slot);
+            m_inflight++;
+            m_creditWaits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return submitOut(slot);
+    }
+
+    return true;
+}
+
+// Called with m_mutex held
+bool Stream::submitOut(Slot &slot)
+{
+    int err = slot.out.submit();
+    if (err != LIBUSB_SUCCESS) {
+        fail(err);
+        return false;
+    }
+    slot.pending++;
+    m_inflight++;
+    m_creditSent += static_cast<uint32_t>(slot.outSize);
+    return true;
+}
+
+// Called with m_mutex held. A transfer larger than the whole device channel
+// goes out once the device has drained.
+bool Stream::hasCredit(size_t size) const
+{
+    if (!m_creditValid)
+        return false;
+    const uint32_t held = m_creditSent - (m_creditLimit - m_creditCapacity);
+    return (held == 0) || (static_cast<int32_t>(m_creditSent + static_cast<uint32_t>(size) - m_creditLimit) <= 0);
+}
+
+// Called with m_mutex held
+void Stream::dropCreditQueue()
+{
+    for (Slot *slot : m_creditQueue) {
+        slot->outQueued = false;
+        m_inflight--;
+    }
+    m_creditQueue.clear();
+    if (m_inflight == 0)
+        m_drained.notify_all();
+}
+
+void Stream::updateCredit(const DeviceEvent &event)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (event.type == DeviceEvent::StreamStart) {
+        // The device counts from zero again
+        m_creditValid = false;
+        return;
+    }
+    if (event.type != DeviceEvent::Credit)
+        return;
+
+    m_creditLimit = event.arg0 + event.arg1;
+    m_creditCapacity = event.arg1;
+    m_creditValid = true;
+    while (!m_creditQueue.empty() && hasCredit(m_creditQueue.front()->outSize)) {
+        Slot &slot = *m_creditQueue.front();
+        m_creditQueue.pop_front();
+        slot.outQueued = false;
+        m_inflight--;
+        if (!submitOut(slot))
+            break;
+    }
+}
+
+void Stream::complete(Slot &slot, Transfer &transfer, bool isIn)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    slot.pending--;
+    m_inflight--;
+
+    int err = transfer.error();
+    if (err != LIBUSB_SUCCESS) {
+        if (!m_stopping)
+            fail(err);
+    } else if (isIn && (transfer.actualLength() == 0) && !m_stopping) {
+        // Flush of an empty device buffer: keep listening, the OUT half of
+        // the slot may still be pending
+        err = transfer.submit();
+        if (err == LIBUSB_SUCCESS) {
+            slot.pending++;
+            m_inflight++;
+            return;
+        }
+        fail(err);
+    } else if (isIn) {
+        const size_t size = static_cast<size_t>(transfer.actualLength());
+        if (size < inTransferSize())
+            m_shortIn.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t sequence = m_inSequence.load(std::memory_order_relaxed);
+        m_bytesIn.fetch_add(size, std::memory_order_relaxed);
+        if (m_data && !m_data(transfer.buffer(), size, sequence)) {
+            if (m_error == LIBUSB_SUCCESS)
+                m_dataRejected = true;
+            fail(LIBUSB_ERROR_OTHER);
+        } else {
+            m_inSequence.store(sequence + 1, std::memory_order_release);
+        }
+    } else {
+        m_bytesOut.fetch_add(static_cast<uint64_t>(transfer.actualLength()), std::memory_order_relaxed);
+    }
+
+    if ((slot.pending == 0) && !slot.outQueued)
+        submitSlot(slot);
+
+    if (m_inflight == 0)
+        m_drained.notify_all();
+}
+
+// Called with m_mutex held
+void Stream::fail(int error)
+{
+    if (m_error == LIBUSB_SUCCESS)
+        m_error = error;
+    m_stopping = true;
+    dropCreditQueue();
+    for (auto &slot : m_slots) {
+        slot->in.cancel();
+        slot->out.cancel();
+    }
+}
+
+// Called with m_mutex held and nothing in flight
+void Stream::release()
+{
+    m_slots.clear();
+    m_pool.clear();
+}
+
+} // namespace fx3link
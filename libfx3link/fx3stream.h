@@ -0,0 +1,146 @@
+#ifndef FX3STREAM_H
+#define FX3STREAM_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "fx3bufferpool.h"
+#include "fx3device.h"
+#include "fx3transfer.h"
+
+namespace fx3link {
+
+struct StreamOptions {
+    size_t transferSize = BulkBufferSize;
+    size_t inTransferSize = 0;      // 0 = transferSize; StreamFlagTimestamp adds a BufferHeader per device buffer
+    unsigned queueDepth = 4;        // Transfers kept in flight per direction
+    bool loopback = true;           // Feed EP1 OUT from the fill handler as well
+    bool creditFlow = false;        // Hold EP1 OUT transfers until the device has room, see updateCredit()
+    unsigned timeout = DefaultTimeout;
+
+    // Transfer size and queue depth for a link speed (Device::speed()).
+    // SuperSpeed wants large transfers and a deep queue to keep the bursts
+    // going; High-Speed saturates with far less and gains latency from it.
+    static StreamOptions forSpeed(int speed);
+};
+
+// Bulk streaming engine keeping a queue of transfers in flight on EP1 IN
+// and, in loopback mode, on EP1 OUT. Buffers are numbered with sequence
+// numbers; a buffer counts as acknowledged once it has been received back
+// on EP1 IN and accepted by the data handler. Handlers run on the libusb
+// event thread, so an EventLoop must be running.
+//
+// With a device flush timeout (StreamConfig::flushTimeoutUs) an IN transfer
+// may end early with a partial buffer; the data handler gets the short size
+// and the sequence then counts IN transfers. Zero-length IN transfers are
+// resubmitted on the spot and never reach the handler.
+//
+// With StreamOptions::creditFlow (device StreamFlagCredit) an OUT transfer
+// is only submitted once the device credit covers it, so EP1 OUT does not
+// sit in USB flow control on a full device; the others queue behind it in
+// order. Feed the device events to updateCredit(). Start the EventListener
+// before setStreamConfig and start the stream right after it, so the
+// StreamStart of the restarted channel lines up the byte counts.
+class Stream
+{
+public:
+    // Fills an OUT buffer, returns the number of bytes to send or 0 to end the stream
+    using FillHandler = std::function<size_t(uint8_t *data, size_t size, uint32_t sequence)>;
+    // Consumes an IN buffer, returns false to fail the stream with
+    // LIBUSB_ERROR_OTHER and dataRejected() set
+    using DataHandler = std::function<bool(const uint8_t *data, size_t size, uint32_t sequence)>;
+
+    explicit Stream(Device &device);
+    ~Stream();
+
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+
+    void setOptions(const StreamOptions &options) { m_options = options; }
+    const StreamOptions &options() const { return m_options; }
+    void onFill(FillHandler handler) { m_fill = std::move(handler); }
+    void onData(DataHandler handler) { m_data = std::move(handler); }
+
+    // Starts numbering buffers at sequence
+    int start(uint32_t sequence = 0);
+    // Cancels all transfers and waits for them to drain
+    void stop();
+    // Waits until the stream ends or fails, returns the first error
+    int wait();
+
+    bool isRunning() const;
+    int error() const;
+    // The stream failed because the data handler rejected a buffer, not on USB
+    bool dataRejected() const;
+    uint32_t acknowledged() const { return m_inSequence.load(std::memory_order_acquire); }
+    uint64_t bytesIn() const { return m_bytesIn.load(std::memory_order_relaxed); }
+    uint64_t bytesOut() const { return m_bytesOut.load(std::memory_order_relaxed); }
+    // IN transfers that ended with a short packet
+    uint64_t shortTransfers() const { return m_shortIn.load(std::memory_order_relaxed); }
+
+    // Takes DeviceEvent::Credit and StreamStart, ignores the other events.
+    // Thread-safe, typically called from the EventListener handler.
+    void updateCredit(const DeviceEvent &event);
+    // OUT transfers that had to wait for credit
+    uint64_t creditWaits() const { return m_creditWaits.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        Transfer out;
+        Transfer in;
+        uint8_t *outBuffer = nullptr;
+        uint8_t *inBuffer = nullptr;
+        size_t outSize = 0;
+        int pending = 0;
+        bool outQueued = false;     // Filled, waiting for credit
+    };
+
+    size_t inTransferSize() const { return m_options.inTransferSize ? m_options.inTransferSize : m_options.transferSize; }
+    bool submitSlot(Slot &slot);
+    bool submitOut(Slot &slot);
+    bool hasCredit(size_t size) const;
+    void dropCreditQueue();
+    void complete(Slot &slot, Transfer &transfer, bool isIn);
+    void fail(int error);
+    void release();
+
+    Device &m_device;
+    StreamOptions m_options;
+    FillHandler m_fill;
+    DataHandler m_data;
+
+    BufferPool m_pool;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_drained;
+    int m_inflight = 0;
+    int m_error = 0;
+    bool m_dataRejected = false;
+    bool m_stopping = false;
+    bool m_ended = false;
+
+    // Slots whose OUT transfer waits for credit count as in flight
+    std::deque<Slot *> m_creditQueue;
+    bool m_creditValid = false;
+    uint32_t m_creditSent = 0;      // OUT bytes submitted since start()
+    uint32_t m_creditLimit = 0;     // Device freed bytes + capacity
+    uint32_t m_creditCapacity = 0;
+
+    uint32_t m_outSequence = 0;
+    std::atomic<uint32_t> m_inSequence{0};
+    std::atomic<uint64_t> m_bytesIn{0};
+    std::atomic<uint64_t> m_bytesOut{0};
+    std::atomic<uint64_t> m_shortIn{0};
+    std::atomic<uint64_t> m_creditWaits{0};
+};
+
+} // namespace fx3link
+
+#endif // FX3STREAM_H
@@ -0,0 +1,92 @@
+#include "fx3thread.h"
+
+#include <errno.h>
+#include <mutex>
+#include <libusb.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace fx3link {
+
+#if defined(__linux__)
+static std::mutex lockMutex;
+static unsigned lockCount = 0;     // lockProcessMemory() calls not yet undone
+
+static int errnoToLibusb(int error)
+{
+    switch (error) {
+    case 0:
+        return LIBUSB_SUCCESS;
+    case EPERM:
+    case EACCES:
+        return LIBUSB_ERROR_ACCESS;
+    case ENOMEM:
+    case EAGAIN:
+        return LIBUSB_ERROR_NO_MEM;
+    default:
+        return LIBUSB_ERROR_INVALID_PARAM;
+    }
+}
+#endif
+
+int pinCurrentThread(int cpu)
+{
+    if (cpu < 0)
+        return LIBUSB_ERROR_INVALID_PARAM;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return errnoToLibusb(pthread_setaffinity_np(pthread_self(), sizeof(set), &set));
+#elif defined(_WIN32)
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) ? LIBUSB_SUCCESS : LIBUSB_ERROR_INVALID_PARAM;
+#else
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+int setCurrentThreadRealtime(int priority)
+{
+    if ((priority < 1) || (priority > 99))
+        return LIBUSB_ERROR_INVALID_PARAM;
+#if defined(__linux__)
+    struct sched_param param = {};
+    param.sched_priority = priority;
+    return errnoToLibusb(pthread_setschedparam(pthread_self(), SCHED_FIFO, &param));
+#elif defined(_WIN32)
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) ? LIBUSB_SUCCESS : LIBUSB_ERROR_ACCESS;
+#else
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+int lockProcessMemory()
+{
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(lockMutex);
+    if ((lockCount == 0) && mlockall(MCL_CURRENT | MCL_FUTURE))
+        return errnoToLibusb(errno);
+    lockCount++;
+    return LIBUSB_SUCCESS;
+#else
+    return LIBUSB_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+void unlockProcessMemory()
+{
+#if defined(__linux__)
+    std::lock_guard<std::mutex> lock(lockMutex);
+    if ((lockCount > 0) && (--lockCount == 0))
+        munlockall();
+#endif
+}
+
+} // namespace fx3link
@@ -0,0 +1,28 @@
+#ifndef FX3THREAD_H
+#define FX3THREAD_H
+
+namespace fx3link {
+
+// Scheduling helpers for latency-critical threads. All return libusb error
+// codes, LIBUSB_ERROR_NOT_SUPPORTED where the platform has no such call and
+// LIBUSB_ERROR_ACCESS where it needs privileges the process lacks.
+
+// Pins the calling thread to one CPU
+int pinCurrentThread(int cpu);
+
+// Moves the calling thread to SCHED_FIFO at priority 1..99 (Linux needs
+// CAP_SYS_NICE or an rtprio limit), or TIME_CRITICAL on Windows
+int setCurrentThreadRealtime(int priority);
+
+// Locks all current and future pages of the process into RAM, so no page
+// fault stalls a real-time thread (Linux needs CAP_IPC_LOCK or a memlock
+// limit). The lock is process-wide and counted: the last unlock calls
+// munlockall(), which also drops an mlockall() the application made
+// itself, so such applications should lock memory only through here or
+// leave EventLoopOptions::lockMemory off.
+int lockProcessMemory();
+void unlockProcessMemory();
+
+} // namespace fx3link
+
+#endif // FX3THREAD_H
@@ -0,0 +1,106 @@
+#include "fx3transfer.h"
+
+#include <utility>
+
+namespace fx3link {
+
+Transfer::Transfer()
+    : m_transfer(libusb_alloc_transfer(0))
+{
+    if (m_transfer)
+        m_transfer->user_data = this;
+}
+
+Transfer::~Transfer()
+{
+    if (m_transfer)
+        libusb_free_transfer(m_transfer);
+}
+
+Transfer::Transfer(Transfer &&other) noexcept
+    : m_transfer(std::exchange(other.m_transfer, nullptr)),
+      m_callback(std::move(other.m_callback)),
+      m_active(other.m_active.exchange(false))
+{
+    if (m_transfer)
+        m_transfer->user_data = this;
+}
+
+Transfer &Transfer::operator=(Transfer &&other) noexcept
+{
+    if (this != &other) {
+        if (m_transfer)
+            libusb_free_transfer(m_transfer);
+        m_transfer = std::exchange(other.m_transfer, nullptr);
+        m_callback = std::move(other.m_callback);
+        m_active.store(other.m_active.exchange(false));
+        if (m_transfer)
+            m_transfer->user_data = this;
+    }
+    return *this;
+}
+
+void Transfer::fillBulk(Device &device, uint8_t endpoint, uint8_t *buffer, int length, unsigned timeout)
+{
+    libusb_fill_bulk_transfer(m_transfer, device.native(), endpoint, buffer, length, complete, this, timeout);
+}
+
+void Transfer::fillInterrupt(Device &device, uint8_t endpoint, uint8_t *buffer, int length, unsigned timeout)
+{
+    libusb_fill_interrupt_transfer(m_transfer, device.native(), endpoint, buffer, length, complete, this, timeout);
+}
+
+void Transfer::fillControl(Device &device, uint8_t direction, uint8_t request, uint16_t value,
+                           uint8_t *buffer, uint16_t length, unsigned timeout)
+{
+    libusb_fill_control_setup(buffer, direction | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
+                              request, value, Interface, length);
+    libusb_fill_control_transfer(m_transfer, device.native(), buffer, complete, this, timeout);
+}
+
+int Transfer::submit()
+{
+    // Set first: the completion may run on the event thread before submit returns
+    m_active.store(true, std::memory_order_release);
+    int err = libusb_submit_transfer(m_transfer);
+    if (err != LIBUSB_SUCCESS)
+        m_active.store(false, std::memory_order_release);
+    return err;
+}
+
+int Transfer::cancel()
+{
+    if (!m_active.load(std::memory_order_acquire))
+        return LIBUSB_ERROR_NOT_FOUND;
+    return libusb_cancel_transfer(m_transfer);
+}
+
+int Transfer::error() const
+{
+    switch (m_transfer->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+        return LIBUSB_SUCCESS;
+    case LIBUSB_TRANSFER_TIMED_OUT:
+        return LIBUSB_ERROR_TIMEOUT;
+    case LIBUSB_TRANSFER_CANCELLED:
+        return LIBUSB_ERROR_INTERRUPTED;
+    case LIBUSB_TRANSFER_STALL:
+        return LIBUSB_ERROR_PIPE;
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        return LIBUSB_ERROR_NO_DEVICE;
+    case LIBUSB_TRANSFER_OVERFLOW:
+        return LIBUSB_ERROR_OVERFLOW;
+    default:
+        return LIBUSB_ERROR_IO;
+    }
+}
+
+void LIBUSB_CALL Transfer::complete(libusb_transfer *transfer)
+{
+    Transfer *self = static_cast<Transfer *>(transfer->user_data);
+    self->m_active.store(false, std::memory_order_release);
+    if (self->m_callback)
+        self->m_callback(*self);
+}
+
+} // namespace fx3link
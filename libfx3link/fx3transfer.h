@@ -0,0 +1,66 @@
+#ifndef FX3TRANSFER_H
+#define FX3TRANSFER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <libusb.h>
+
+#include "fx3device.h"
+
+namespace fx3link {
+
+// Asynchronous libusb transfer. Move-only; must not be moved or destroyed
+// while submitted. The completion callback runs on the thread handling
+// libusb events and is set once, so resubmission does not allocate.
+class Transfer
+{
+public:
+    using Callback = std::function<void(Transfer &)>;
+
+    Transfer();
+    ~Transfer();
+
+    Transfer(Transfer &&other) noexcept;
+    Transfer &operator=(Transfer &&other) noexcept;
+    Transfer(const Transfer &) = delete;
+    Transfer &operator=(const Transfer &) = delete;
+
+    void setCallback(Callback callback) { m_callback = std::move(callback); }
+
+    void fillBulk(Device &device, uint8_t endpoint, uint8_t *buffer, int length,
+                  unsigned timeout = DefaultTimeout);
+    void fillInterrupt(Device &device, uint8_t endpoint, uint8_t *buffer, int length,
+                       unsigned timeout = DefaultTimeout);
+    // Vendor request addressed to the interface. The buffer must hold
+    // LIBUSB_CONTROL_SETUP_SIZE + length bytes; OUT data goes to controlData().
+    void fillControl(Device &device, uint8_t direction, uint8_t request, uint16_t value,
+                     uint8_t *buffer, uint16_t length, unsigned timeout = DefaultTimeout);
+
+    int submit();
+    int cancel();
+
+    bool isValid() const { return m_transfer != nullptr; }
+    bool isActive() const { return m_active.load(std::memory_order_acquire); }
+    libusb_transfer *native() const { return m_transfer; }
+
+    uint8_t *buffer() const { return m_transfer->buffer; }
+    uint8_t *controlData() const { return m_transfer->buffer + LIBUSB_CONTROL_SETUP_SIZE; }
+    int length() const { return m_transfer->length; }
+    int actualLength() const { return m_transfer->actual_length; }
+    libusb_transfer_status status() const { return m_transfer->status; }
+
+    // Completion status as a libusb error code (LIBUSB_SUCCESS if completed)
+    int error() const;
+
+private:
+    static void LIBUSB_CALL complete(libusb_transfer *transfer);
+
+    libusb_transfer *m_transfer = nullptr;
+    Callback m_callback;
+    std::atomic<bool> m_active{false};     // Written on the event thread
+};
+
+} // namespace fx3link
+
+#endif // FX3TRANSFER_H
@@ -0,0 +1,7 @@
+# Include this file from an application project to link against libfx3link
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+LIBS += -L$$OUT_PWD/../lib -lfx3link
+PRE_TARGETDEPS += $$OUT_PWD/../lib/libfx3link.a
+
+include(libusb.pri)
@@ -0,0 +1,46 @@
+TEMPLATE = lib
+CONFIG += staticlib c++17
+CONFIG -= qt
+
+TARGET = fx3link
+DESTDIR = $$OUT_PWD/../lib
+
+HEADERS += \
+        fx3bufferpool.h \
+        fx3clock.h \
+        fx3codec.h \
+        fx3context.h \
+        fx3coro.h \
+        fx3crc.h \
+        fx3device.h \
+        fx3eventloop.h \
+        fx3events.h \
+        fx3link.h \
+        fx3log.h \
+        fx3pattern.h \
+        fx3pipeline.h \
+        fx3protocol.h \
+        fx3queue.h \
+        fx3reconnect.h \
+        fx3stream.h \
+        fx3thread.h \
+        fx3transfer.h
+
+SOURCES += \
+        fx3bufferpool.cpp \
+        fx3clock.cpp \
+        fx3codec.cpp \
+        fx3context.cpp \
+        fx3crc.cpp \
+        fx3device.cpp \
+        fx3eventloop.cpp \
+        fx3events.cpp \
+        fx3log.cpp \
+        fx3pattern.cpp \
+        fx3pipeline.cpp \
+        fx3reconnect.cpp \
+        fx3stream.cpp \
+        fx3thread.cpp \
+        fx3transfer.cpp
+
+include(libusb.pri)
@@ -0,0 +1,3 @@
+INCLUDEPATH += $$PWD/../../libusb-1.0.27/include
+LIBS += -L$$PWD/../../libusb-1.0.27/MinGW32/static
+LIBS += -llibusb-1.0 -llibusb-1.0.dll
@@ -6,6 +6,4 @@ CONFIG -= qt
 SOURCES += \
         main.cpp
 
-INCLUDEPATH += $$PWD/../../libusb-1.0.27/include
-LIBS += -L$$PWD/../../libusb-1.0.27/MinGW32/static
-LIBS += -llibusb-1.0 -llibusb-1.0.dll
+include(../libfx3link/libfx3link.pri)
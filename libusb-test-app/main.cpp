@@ -1,22 +1,32 @@
 #include <stdio.h>
-#include <libusb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fx3link.h>
 
-#define CY_FX_USB_VID           (0x04B4)
-#define CY_FX_USB_PID           (0x0101)
-#define CY_FX_VENDOR_REQUEST    (0xFF) /* Vendor request type code */
-#define DEFAULT_USB_TIMEOUT     (1000) /* 1000 ms */
+using namespace fx3link;
 
-libusb_context *ctx = nullptr;
-libusb_device_handle *handle = nullptr;
-unsigned char ep0Buffer[64];
+#define STREAM_DEFAULT_LENGTH   (1000) /* Buffers to loop back if not given on the command line */
+#define STREAM_QUEUE_DEPTH      (2)
 
-int main()
+// Fills each 32-bit word with sequence + index, so the first word carries the sequence number
+static size_t fillPattern(uint8_t *data, size_t size, uint32_t sequence)
 {
+    uint32_t *words = reinterpret_cast<uint32_t *>(data);
+    for (size_t i = 0; i < size / sizeof(uint32_t); i++)
+        words[i] = sequence + static_cast<uint32_t>(i);
+    return size;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t streamLength = (argc > 1) ? strtoul(argv[1], nullptr, 0) : STREAM_DEFAULT_LENGTH;
 
     // Init library
-    int rc = libusb_init(&ctx);
-    if (rc < 0) {
-        printf("FAIL on 'libusb_init'! ( %s )\n", libusb_error_name(rc));
+    Context ctx;
+    int err = ctx.init();
+    if (err < 0) {
+        printf("FAIL on 'libusb_init'! ( %s )\n", errorName(err));
         return -1;
     }
 
@@ -25,107 +35,108 @@ int main()
     v = libusb_get_version();
     printf("LibUSB %d.%d.%d.%d\n", v->major, v->minor, v->micro, v->nano);
 
-    // Getting device list
-    ssize_t cnt;
-    libusb_device **dev_list;
-    cnt = libusb_get_device_list(ctx, &dev_list);
-    if (cnt < 0) {
-        printf("FAIL on 'libusb_get_device_list'! ( %s )\n", libusb_error_name(cnt));
-        return -1;
-    }
-
-    // Searching for device
-    int err;
-    int idx = -1;
-    struct libusb_device_descriptor dev_desc;
-    for (int i = 0; dev_list[i]; i++) {
-        err = libusb_get_device_descriptor(dev_list[i], &dev_desc);
-        if (err != LIBUSB_SUCCESS)
-        {
-            printf("FAIL on 'libusb_get_device_descriptor'! ( %s )\n", libusb_error_name(err));
-            continue;
-        }
-        if ((dev_desc.idVendor == CY_FX_USB_VID) && (dev_desc.idProduct == CY_FX_USB_PID))
-        {
-            printf("Device found : VID_0x%04X&PID_0x%04X USB %X.%X REV %X.%X\n",
-                   dev_desc.idVendor, dev_desc.idProduct,
-                   dev_desc.bcdUSB >> 8, dev_desc.bcdUSB & 0xFF,
-                   dev_desc.bcdDevice >> 8, dev_desc.bcdDevice & 0xFF);
-            idx = i;
-            break;
-        }
-    }
-
-    // Check if device not found
-    if (idx == -1) {
+    Device device;
+    err = device.open(ctx);
+    if (err == LIBUSB_ERROR_NOT_FOUND) {
         printf("No device found.\n");
-        libusb_free_device_list(dev_list, 1);
-        libusb_exit(ctx);
         return 0;
     }
-
-    // Opening the device
-    err = libusb_open(dev_list[idx], &handle);
-    if (err != LIBUSB_SUCCESS)
-    {
-        printf("FAIL on 'libusb_open'! ( %s )\n", libusb_error_name(err));
-        libusb_free_device_list(dev_list, 1);
-        libusb_exit(ctx);
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on device open! ( %s )\n", errorName(err));
         return -1;
     }
 
-    // Device additional information
-    unsigned char data[128];
-    libusb_get_string_descriptor_ascii(handle, dev_desc.iManufacturer, data, sizeof(data));
-    printf("Manufacturer : %s\n", data);
-    libusb_get_string_descriptor_ascii(handle, dev_desc.iProduct, data, sizeof(data));
-    printf("Product      : %s\n", data);
-    libusb_get_string_descriptor_ascii(handle, dev_desc.iSerialNumber, data, sizeof(data));
-    printf("Serial number: %s\n", data);
+    const DeviceInfo &info = device.info();
+    printf("Device found : VID_0x%04X&PID_0x%04X USB %X.%X REV %X.%X\n",
+           info.vid, info.pid,
+           info.bcdUSB >> 8, info.bcdUSB & 0xFF,
+           info.bcdDevice >> 8, info.bcdDevice & 0xFF);
+    printf("Manufacturer : %s\n", info.manufacturer.c_str());
+    printf("Product      : %s\n", info.product.c_str());
+    printf("Serial number: %s\n", info.serialNumber.c_str());
 
     // Fill buffer by a pattern value
+    unsigned char ep0Buffer[64];
     memset(ep0Buffer, 0xAA, sizeof(ep0Buffer));
 
     // Control transfer to device
-    err = libusb_control_transfer(handle,
-                                  LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
-                                  CY_FX_VENDOR_REQUEST, // bRequest
-                                  0x00,                 // wValue
-                                  0x00,                 // wIndex
-                                  ep0Buffer,            // Buffer to send or receive
-                                  sizeof(ep0Buffer),
-                                  DEFAULT_USB_TIMEOUT);
-    if (err < 0)
-    {
-        printf("FAIL on 'libusb_control_transfer'! ( %s )\n", libusb_error_name(err));
-        libusb_close(handle);
-        libusb_free_device_list(dev_list, 1);
-        libusb_exit(ctx);
+    err = device.controlOut(VendorRequest, 0x00, ep0Buffer, sizeof(ep0Buffer));
+    if (err < 0) {
+        printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(err));
         return -1;
     }
     printf("EP0 buffer first byte sent    : 0x%02X\n", ep0Buffer[0]);
 
     // Control transfer from device
-    err = libusb_control_transfer(handle,
-                                  LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_INTERFACE,
-                                  CY_FX_VENDOR_REQUEST, // bRequest
-                                  0x00,                 // wValue
-                                  0x00,                 // wIndex
-                                  ep0Buffer,            // Buffer to send or receive
-                                  sizeof(ep0Buffer),
-                                  DEFAULT_USB_TIMEOUT);
-    if (err < 0)
-    {
-        printf("FAIL on 'libusb_control_transfer'! ( %s )\n", libusb_error_name(err));
-        libusb_close(handle);
-        libusb_free_device_list(dev_list, 1);
-        libusb_exit(ctx);
+    err = device.controlIn(VendorRequest, 0x00, ep0Buffer, sizeof(ep0Buffer));
+    if (err < 0) {
+        printf("FAIL on 'libusb_control_transfer'! ( %s )\n", errorName(err));
         return -1;
     }
     printf("EP0 buffer first byte received: 0x%02X\n", ep0Buffer[0]);
 
-    libusb_close(handle);
-    libusb_free_device_list(dev_list, 1);
-    libusb_exit(ctx);
-    return 0;
+    // Bulk loopback stream under the reconnect supervisor
+    EventLoop loop(ctx);
+    ReconnectSupervisor supervisor(ctx);
+    StreamConfig config;
+    Stream stream(device);
+    StreamOptions options = StreamOptions::forSpeed(device.speed());
+    options.queueDepth = STREAM_QUEUE_DEPTH;
+    stream.setOptions(options);
+
+    stream.onFill([streamLength](uint8_t *data, size_t size, uint32_t sequence) -> size_t {
+        return (sequence < streamLength) ? fillPattern(data, size, sequence) : 0;
+    });
+    stream.onData([](const uint8_t *data, size_t size, uint32_t sequence) {
+        uint32_t first = 0;
+        if (size >= sizeof(first))
+            memcpy(&first, data, sizeof(first));
+        if ((size < sizeof(first)) || (first != sequence)) {
+            printf("Stream data mismatch at sequence %u\n", sequence);
+            return false;
+        }
+        return true;
+    });
+
+    err = loop.start();
+    if (err != LIBUSB_SUCCESS) {
+        printf("FAIL on event loop! ( %s )\n", errorName(err));
+        return -1;
+    }
+    err = device.setStreamConfig(config);
+    while (true) {
+        if (err == LIBUSB_SUCCESS) {
+            err = stream.start(stream.acknowledged());
+            if (err == LIBUSB_SUCCESS)
+                err = stream.wait();
+            stream.stop();
+            if (err == LIBUSB_SUCCESS)
+                break;
+        }
+        if (stream.dataRejected() || !ReconnectSupervisor::isReconnectable(err)) {
+            printf("FAIL on stream at sequence %u! ( %s )\n", stream.acknowledged(), errorName(err));
+            break;
+        }
+
+        printf("Stream interrupted at sequence %u ( %s ), reconnecting...\n", stream.acknowledged(), errorName(err));
+
+        // Resume from the last buffer the host has received back
+        config.sequence = stream.acknowledged();
+        err = supervisor.reconnect(device, config);
+        if (err != LIBUSB_SUCCESS) {
+            printf("Device did not come back within %lld ms! ( %s )\n",
+                   static_cast<long long>(supervisor.timeout().count()), errorName(err));
+            break;
+        }
+        printf("Reconnected in %lld ms, resuming from sequence %u\n",
+               static_cast<long long>(supervisor.stats().last.count()), stream.acknowledged());
+    }
+    loop.stop();
+
+    const ReconnectStats &stats = supervisor.stats();
+    printf("Stream buffers : %u of %u\n", stream.acknowledged(), streamLength);
+    printf("Reconnects     : %u (downtime total %lld ms, max %lld ms)\n", stats.count,
+           static_cast<long long>(stats.total.count()), static_cast<long long>(stats.max.count()));
+
+    return (err == LIBUSB_SUCCESS) ? 0 : -1;
 }
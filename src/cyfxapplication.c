@@ -6,18 +6,739 @@
 **
 ****************************************************************************/
 
+#include <cyu3os.h>
 #include <cyu3system.h>
 #include <cyu3error.h>
+#include <cyu3dma.h>
+#include <cyu3usb.h>
+#include <cyu3gpio.h>
 #include "cyfxdebug.h"
+#include "cyfxusb.h"
+#include "cyfxapplication.h"
+#include "cyfxtx.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+#include "cyfxlog.h"
+#include "cyfxthreadmon.h"
+#include "cyfxlatency.h"
+#include "cyfxevent.h"
+#include "cyfxcrc.h"
+#include "cyfxcodec.h"
 
-CyU3PReturnStatus_t CyFxUsbAppStart(void)
+#define CY_FX_EP_PRODUCER_SOCKET        (CY_U3P_UIB_SOCKET_PROD_1)
+#define CY_FX_EP_CONSUMER_SOCKET        (CY_U3P_UIB_SOCKET_CONS_1)
+#define CY_FX_EP_EVENT_SOCKET           (CY_U3P_UIB_SOCKET_CONS_2)
+
+#define CY_FX_WORKER_THREAD_STACK       (0x800)
+#define CY_FX_WORKER_THREAD_PRIORITY    (7)     /* Above the application thread */
+#define CY_FX_WORKER_QUEUE_LENGTH       (16)    /* Messages */
+#define CY_FX_WORKER_QUEUE_RESERVE      (6)     /* Kept free of traces for the other commands */
+
+extern void CyFxFatalErrorHandler(const char* msg, CyU3PReturnStatus_t status, CyBool_t noReturn);
+extern void CyFxUsbTraceRequest(uint32_t setupdat0, uint32_t setupdat1, CyBool_t isHandled);
+extern void CyFxUsbTraceEvent(uint32_t evType, uint32_t evData);
+
+CyBool_t glIsApplnActive = CyFalse;     /* Whether the bulk loopback channel is running */
+CyU3PDmaChannel glChHandleBulkLp;       /* DMA channel EP1 OUT -> EP1 IN */
+CyU3PDmaChannel glChHandleEvent;        /* DMA channel CPU -> EP2 IN */
+uint32_t glEventCommitted = 0;          /* Event packets committed to EP2 IN */
+uint32_t glEventConsumed = 0;           /* Event packets the host took */
+uint32_t glBulkInFlight = 0;            /* Bulk buffers produced and not yet consumed */
+uint32_t glBulkOverrunCount = 0;        /* Times all bulk buffers were full */
+uint32_t glBulkProducedBytes = 0;       /* Bytes in the bulk buffers produced so far */
+uint32_t glFlushLastCount = 0;          /* Producer byte count at the previous flush tick */
+uint32_t glBulkFlushCount = 0;          /* Partial buffers wrapped up by the flush timer */
+volatile CyBool_t glFlushPending = CyFalse; /* A flush tick waits for the worker */
+
+/* Stream configuration is kept across USB resets, so the host can restore it after reconnect */
+CyFxStreamConfig_t glStreamConfig = { 0, 0, 0, 0 };
+uint16_t glBulkBufferSize = 0;          /* Bulk channel in use, set from the link speed */
+uint16_t glBulkBufferCount = 0;
+CyBool_t glBulkManual = CyFalse;        /* The firmware commits every bulk buffer */
+CyBool_t glBulkTimestamp = CyFalse;     /* Manual channel adding CyFxBufferHeader_t */
+CyBool_t glBulkCrcAppend = CyFalse;     /* ... and a CRC trailer */
+CyBool_t glBulkCrcCheck = CyFalse;      /* ... checking the EP1 OUT trailers */
+uint8_t glBulkCodec = CY_FX_CODEC_STORED; /* ... encoding the payload into a frame */
+uint32_t glBulkOverhead = 0;            /* Header and trailer bytes added to each IN buffer */
+uint16_t glBulkRawLength[CY_FX_BULK_BUFFER_COUNT_MAX]; /* Payload bytes by sequence, for the credit of a frame */
+uint32_t glBulkConsumedSeq = 0;         /* Sequence of the next buffer EP1 IN consumes */
+uint32_t glBulkHeaderSeq = 0;           /* Next CyFxBufferHeader_t sequence */
+CyBool_t glBulkCredit = CyFalse;        /* Credit events enabled */
+uint32_t glBulkCapacity = 0;            /* EP1 OUT payload bytes the channel holds */
+uint32_t glBulkFreedBytes = 0;          /* EP1 OUT payload bytes consumed by EP1 IN */
+uint32_t glCreditSentBytes = 0;         /* glBulkFreedBytes in the last credit event */
+uint16_t glUsbResetCount = 0;
+uint16_t glStreamConfigCount = 0;       /* Configurations the worker handled */
+uint16_t glStreamConfigStatus = 0;      /* Result of the last one */
+
+CyU3PMutex glAppLock;                   /* Guards the channel against readers on other threads */
+CyU3PThread glWorkerThread;             /* Data and control worker */
+CyU3PQueue glWorkerQueue;               /* Commands posted by the USB callbacks */
+uint32_t glWorkerQueueBuffer[CY_FX_WORKER_QUEUE_LENGTH * sizeof(CyFxAppMessage_t) / 4] CY_FX_DTCM_DATA;
+uint8_t glWorkerStack[CY_FX_WORKER_THREAD_STACK] CY_FX_DTCM_DATA __attribute__ ((aligned (8)));
+uint32_t glWorkerQueued = 0;            /* Messages posted and not yet received */
+uint32_t glWorkerDropCount = 0;         /* Messages lost because the queue was full */
+uint32_t glTraceDropCount = 0;          /* Traces left out to keep the reserve free */
+volatile CyBool_t glAppStopOwed = CyFalse; /* An APP_STOP post was lost, see CyFxAppPostStop */
+
+static CyU3PReturnStatus_t CyFxUsbAppStopLocked(void);
+
+/* Checks the OUT trailer, encodes the payload, fills in the reserved
+ * header, appends the IN trailer and passes the buffer on to EP1 IN. The
+ * buffer pointer starts at the header, the count covers the payload only. */
+CY_FX_ITCM_CODE static void CyFxAppBulkCommit(CyU3PDmaChannel *chHandle, CyU3PDmaBuffer_t *buffer)
+{
+    uint64_t ticks = CyFxTimerNow64();
+    uint32_t sequence = glBulkHeaderSeq++;
+    uint32_t length = buffer->count;
+    CyFxBufferHeader_t *header;
+
+    if (glBulkCrcCheck)
+        CyFxCrcCheck(buffer->buffer + (glBulkTimestamp ? CY_FX_BUFFER_HEADER_SIZE : 0), length);
+
+    if (glBulkCodec != CY_FX_CODEC_STORED)
+    {
+        glBulkRawLength[sequence & (CY_FX_BULK_BUFFER_COUNT_MAX - 1)] = (uint16_t)length;
+        length = CyFxCodecEncode(buffer->buffer + CY_FX_BUFFER_HEADER_SIZE, length, glBulkCodec);
+    }
+
+    if (glBulkTimestamp)
+    {
+        header = (CyFxBufferHeader_t *)buffer->buffer;
+        header->sequence = sequence;
+        header->length   = length;
+        header->ticksLo  = (uint32_t)ticks;
+        header->ticksHi  = (uint32_t)(ticks >> 32);
+        length += CY_FX_BUFFER_HEADER_SIZE;
+    }
+
+    if (glBulkCrcAppend)
+    {
+        CyFxCrcAppend(buffer->buffer, length);
+        length += CY_FX_CRC_SIZE;
+    }
+
+    if (CyU3PDmaChannelCommitBuffer(chHandle, length, 0) != CY_U3P_SUCCESS)
+        CyFxEventSend(CY_FX_EVENT_DMA_ERROR, 1, sequence);
+}
+
+/* Counts a consumed buffer towards the host's credit, see cyfxapplication.h */
+CY_FX_ITCM_CODE static void CyFxAppBulkCredit(uint32_t count)
+{
+    /* Buffers leave in the order they were committed */
+    if (glBulkCodec != CY_FX_CODEC_STORED)
+        glBulkFreedBytes += glBulkRawLength[glBulkConsumedSeq++ & (CY_FX_BULK_BUFFER_COUNT_MAX - 1)];
+    else
+        glBulkFreedBytes += count - glBulkOverhead;
+    if ((glBulkFreedBytes - glCreditSentBytes >= glBulkCapacity / CY_FX_CREDIT_STEP_DIV) || (glBulkInFlight == 0))
+    {
+        glCreditSentBytes = glBulkFreedBytes;
+        CyFxEventSend(CY_FX_EVENT_CREDIT, glBulkFreedBytes, glBulkCapacity);
+    }
+}
+
+/* Bulk channel notifications, used to time the buffers and to spot overruns */
+CY_FX_ITCM_CODE void CyFxAppDmaCallback(CyU3PDmaChannel *chHandle, CyU3PDmaCbType_t type, CyU3PDmaCBInput_t *input)
+{
+    switch (type)
+    {
+    case CY_U3P_DMA_CB_PROD_EVENT:
+        glBulkProducedBytes += input->buffer_p.count;
+        CyFxLatencyDmaProduced();
+        if (++glBulkInFlight == glBulkBufferCount)
+        {
+            glBulkOverrunCount++;
+            CyFxEventSend(CY_FX_EVENT_OVERRUN, 1, glBulkBufferCount);
+        }
+        if (glBulkManual)
+            CyFxAppBulkCommit(chHandle, &input->buffer_p);
+        break;
+    case CY_U3P_DMA_CB_CONS_EVENT:
+        CyFxLatencyDmaConsumed();
+        if (glBulkInFlight != 0)
+            glBulkInFlight--;
+        if (glBulkCredit)
+            CyFxAppBulkCredit(input->buffer_p.count);
+        break;
+    case CY_U3P_DMA_CB_ERROR:
+        CyFxEventSend(CY_FX_EVENT_DMA_ERROR, 0, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+/* The host took an event packet, there is room for the next one */
+void CyFxAppEventDmaCallback(CyU3PDmaChannel *chHandle, CyU3PDmaCbType_t type, CyU3PDmaCBInput_t *input)
+{
+    if (type != CY_U3P_DMA_CB_CONS_EVENT)
+        return;
+    glEventConsumed++;
+    if (CyFxEventPending())
+        CyFxEventRequestFlush();
+}
+
+/* Interrupt endpoint and the manual channel feeding it */
+static CyU3PReturnStatus_t CyFxAppEventStartLocked(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+    CyU3PEpConfig_t epConfig;
+    CyU3PDmaChannelConfig_t dmaConfig;
+
+    CyU3PMemSet((uint8_t *)&epConfig, 0, sizeof(epConfig));
+    epConfig.enable   = CyTrue;
+    epConfig.epType   = CY_U3P_USB_EP_INTR;
+    epConfig.burstLen = 1;
+    epConfig.streams  = 0;
+    epConfig.pcktSize = CY_FX_EVENT_PACKET_SIZE;
+
+    apiRetStatus = CyU3PSetEpConfig(CY_FX_EP_EVENT, &epConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PSetEpConfig", apiRetStatus, CyFalse);
+        return apiRetStatus;
+    }
+
+    CyU3PMemSet((uint8_t *)&dmaConfig, 0, sizeof(dmaConfig));
+    dmaConfig.size           = 32;      /* One cache line, a packet uses the first half */
+    dmaConfig.count          = CY_FX_EVENT_BUFFER_COUNT;
+    dmaConfig.prodSckId      = CY_U3P_CPU_SOCKET_PROD;
+    dmaConfig.consSckId      = CY_FX_EP_EVENT_SOCKET;
+    dmaConfig.dmaMode        = CY_U3P_DMA_MODE_BYTE;
+    dmaConfig.notification   = CY_U3P_DMA_CB_CONS_EVENT;
+    dmaConfig.cb             = CyFxAppEventDmaCallback;
+
+    apiRetStatus = CyU3PDmaChannelCreate(&glChHandleEvent, CY_U3P_DMA_TYPE_MANUAL_OUT, &dmaConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PDmaChannelCreate", apiRetStatus, CyFalse);
+        return apiRetStatus;
+    }
+
+    glEventCommitted = 0;
+    glEventConsumed = 0;
+    CyU3PUsbFlushEp(CY_FX_EP_EVENT);
+    apiRetStatus = CyU3PDmaChannelSetXfer(&glChHandleEvent, 0);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PDmaChannelSetXfer", apiRetStatus, CyFalse);
+        CyU3PDmaChannelDestroy(&glChHandleEvent);
+    }
+    return apiRetStatus;
+}
+
+/* Starts the flush timer, 0 stops it */
+static CyU3PReturnStatus_t CyFxAppFlushTimerSet(uint16_t timeoutUs)
+{
+    CyU3PGpioComplexConfig_t gpioConfig;
+
+    CyU3PMemSet((uint8_t *)&gpioConfig, 0, sizeof(gpioConfig));
+    gpioConfig.pinMode   = CY_U3P_GPIO_MODE_STATIC;
+    gpioConfig.intrMode  = (timeoutUs != 0) ? CY_U3P_GPIO_INTR_TIMER_ZERO : CY_U3P_GPIO_NO_INTR;
+    gpioConfig.timerMode = (timeoutUs != 0) ? CY_U3P_GPIO_TIMER_HIGH_FREQ : CY_U3P_GPIO_TIMER_SHUTDOWN;
+    gpioConfig.timer     = 0;
+    gpioConfig.period    = (CY_FX_TIMER_HZ / 100000) * timeoutUs / 10;
+    gpioConfig.threshold = gpioConfig.period;
+    return CyU3PGpioSetComplexConfig(CY_FX_GPIO_FLUSH, &gpioConfig);
+}
+
+/* GPIO interrupt context */
+void CyFxStreamFlushTick(void)
+{
+    if (!glFlushPending && (CyFxAppPost(CY_FX_CMD_BULK_FLUSH, NULL, 0) == CY_U3P_SUCCESS))
+        glFlushPending = CyTrue;
+}
+
+/* Wraps up the bulk producer buffer if it holds data and nothing arrived for a whole tick */
+static void CyFxAppBulkFlush(void)
+{
+    CyU3PDmaState_t state;
+    uint32_t prodXferCount = 0;
+    uint32_t consXferCount = 0;
+
+    glFlushPending = CyFalse;
+    CyU3PMutexGet(&glAppLock, CYU3P_WAIT_FOREVER);
+    if (glIsApplnActive
+            && (CyU3PDmaChannelGetStatus(&glChHandleBulkLp, &state, &prodXferCount, &consXferCount) == CY_U3P_SUCCESS))
+    {
+        /* The producer count includes the buffer being filled, the produce
+         * events only the buffers handed on */
+        if ((prodXferCount == glFlushLastCount) && (prodXferCount != glBulkProducedBytes)
+                && (CyU3PDmaChannelSetWrapUp(&glChHandleBulkLp) == CY_U3P_SUCCESS))
+            glBulkFlushCount++;
+        glFlushLastCount = prodXferCount;
+    }
+    CyU3PMutexPut(&glAppLock);
+}
+
+/* Moves queued events into the free endpoint buffers */
+static void CyFxAppEventFlush(void)
 {
-    CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Application started...\r\n");
+    CyU3PDmaBuffer_t buffer;
+
+    CyU3PMutexGet(&glAppLock, CYU3P_WAIT_FOREVER);
+    while (glIsApplnActive && CyFxEventPending()
+            && (CyU3PDmaChannelGetBuffer(&glChHandleEvent, &buffer, CYU3P_NO_WAIT) == CY_U3P_SUCCESS))
+    {
+        if (!CyFxEventPop((CyFxEventRecord_t *)buffer.buffer))
+            break;
+        CyU3PDmaChannelCommitBuffer(&glChHandleEvent, sizeof(CyFxEventRecord_t), 0);
+        glEventCommitted++;
+    }
+    CyU3PMutexPut(&glAppLock);
+}
+
+static CyU3PReturnStatus_t CyFxUsbAppStartLocked(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+    CyU3PEpConfig_t epConfig;
+    CyU3PDmaChannelConfig_t dmaConfig;
+    CyU3PUSBSpeed_t usbSpeed = CyU3PUsbGetSpeed();
+    uint16_t epSize = 0;
+    CyBool_t isTimestamped = ((glStreamConfig.flags & CY_FX_STREAM_FLAG_TIMESTAMP) != 0);
+    CyBool_t isCredited = ((glStreamConfig.flags & CY_FX_STREAM_FLAG_CREDIT) != 0);
+    CyBool_t isManual = ((glStreamConfig.flags & CY_FX_STREAM_FLAGS_MANUAL) != 0);
+    CyBool_t isSignalled = (isManual || isCredited || CY_FX_LATENCY_DMA_ENABLE
+            || (glStreamConfig.flushTimeoutUs != 0));
+
+    /* Restart the data path if the host sends SET_CONFIGURATION again */
+    if (glIsApplnActive)
+        CyFxUsbAppStopLocked();
+
+    /* Deep bursts and more buffers at SuperSpeed; at High-Speed smaller
+     * buffers keep the latency down and the arena slots free */
+    switch (usbSpeed)
+    {
+    case CY_U3P_SUPER_SPEED:
+        epSize            = CY_FX_SUPER_SPEED_EP_SIZE;
+        glBulkBufferSize  = CY_FX_SS_BULK_BUFFER_SIZE;
+        glBulkBufferCount = CY_FX_SS_BULK_BUFFER_COUNT;
+        break;
+    case CY_U3P_HIGH_SPEED:
+        epSize            = CY_FX_HIGH_SPEED_EP_SIZE;
+        glBulkBufferSize  = CY_FX_HS_BULK_BUFFER_SIZE;
+        glBulkBufferCount = CY_FX_HS_BULK_BUFFER_COUNT;
+        break;
+    default:
+        CyFxFatalErrorHandler("Unsupported USB speed", usbSpeed, CyFalse);
+        return CY_U3P_ERROR_FAILURE;
+    }
+
+    if (glStreamConfig.bufferCount != 0)
+        glBulkBufferCount = glStreamConfig.bufferCount;
+    else if ((glFxMemMap.arenaSlots != 0) && (glBulkBufferCount > glFxMemMap.arenaSlots))
+        glBulkBufferCount = glFxMemMap.arenaSlots;
+
+    CyU3PMemSet((uint8_t *)&epConfig, 0, sizeof(epConfig));
+    epConfig.enable   = CyTrue;
+    epConfig.epType   = CY_U3P_USB_EP_BULK;
+    epConfig.burstLen = (usbSpeed == CY_U3P_SUPER_SPEED) ? CY_FX_EP_BURST_LENGTH : 1;
+    epConfig.streams  = 0;
+    epConfig.pcktSize = epSize;
+
+    apiRetStatus = CyU3PSetEpConfig(CY_FX_EP_PRODUCER, &epConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PSetEpConfig", apiRetStatus, CyFalse);
+        return apiRetStatus;
+    }
+
+    apiRetStatus = CyU3PSetEpConfig(CY_FX_EP_CONSUMER, &epConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PSetEpConfig", apiRetStatus, CyFalse);
+        return apiRetStatus;
+    }
+
+    /* Auto DMA channel, the firmware is not involved in the data transfer.
+     * For the latency histograms and the flush timer it gets notified of
+     * every buffer, which also reports the overruns on the event endpoint.
+     * Headers and trailers need a manual channel; with a header the footer
+     * keeps the producer space a whole number of packets and leaves room
+     * for the frame and IN trailers. */
+    CyU3PMemSet((uint8_t *)&dmaConfig, 0, sizeof(dmaConfig));
+    dmaConfig.size           = glBulkBufferSize;
+    dmaConfig.count          = glBulkBufferCount;
+    dmaConfig.prodSckId      = CY_FX_EP_PRODUCER_SOCKET;
+    dmaConfig.consSckId      = CY_FX_EP_CONSUMER_SOCKET;
+    dmaConfig.dmaMode        = CY_U3P_DMA_MODE_BYTE;
+    dmaConfig.notification   = isSignalled ?
+            (CY_U3P_DMA_CB_PROD_EVENT | CY_U3P_DMA_CB_CONS_EVENT | CY_U3P_DMA_CB_ERROR) : CY_U3P_DMA_CB_ERROR;
+    dmaConfig.cb             = CyFxAppDmaCallback;
+    dmaConfig.prodHeader     = isTimestamped ? CY_FX_BUFFER_HEADER_SIZE : 0;
+    dmaConfig.prodFooter     = isTimestamped ? (epSize - CY_FX_BUFFER_HEADER_SIZE) : 0;
+    dmaConfig.consHeader     = 0;
+    dmaConfig.prodAvailCount = 0;
+
+    CyFxLatencyDmaRestart();
+    glBulkManual = isManual;
+    glBulkTimestamp = isTimestamped;
+    glBulkCrcAppend = ((glStreamConfig.flags & CY_FX_STREAM_FLAG_CRC) != 0);
+    glBulkCrcCheck = ((glStreamConfig.flags & CY_FX_STREAM_FLAG_CRC_CHECK) != 0);
+    glBulkCodec = ((glStreamConfig.flags & CY_FX_STREAM_FLAG_RLE) ? CY_FX_CODEC_RLE : 0)
+            | ((glStreamConfig.flags & CY_FX_STREAM_FLAG_DELTA16) ? CY_FX_CODEC_DELTA16 : 0);
+    glBulkConsumedSeq = 0;
+    glBulkOverhead = (isTimestamped ? CY_FX_BUFFER_HEADER_SIZE : 0) + (glBulkCrcAppend ? CY_FX_CRC_SIZE : 0);
+    glBulkHeaderSeq = 0;
+    glBulkCredit = isCredited;
+    glBulkCapacity = glBulkBufferCount * (isTimestamped ? (glBulkBufferSize - epSize) : glBulkBufferSize);
+    glBulkFreedBytes = 0;
+    glCreditSentBytes = 0;
+    apiRetStatus = CyU3PDmaChannelCreate(&glChHandleBulkLp, isManual ? CY_U3P_DMA_TYPE_MANUAL :
+            (isSignalled ? CY_U3P_DMA_TYPE_AUTO_SIGNAL : CY_U3P_DMA_TYPE_AUTO), &dmaConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PDmaChannelCreate", apiRetStatus, CyFalse);
+        return apiRetStatus;
+    }
+
+    CyU3PUsbFlushEp(CY_FX_EP_PRODUCER);
+    CyU3PUsbFlushEp(CY_FX_EP_CONSUMER);
+
+    /* Infinite transfer */
+    glBulkInFlight = 0;
+    glBulkProducedBytes = 0;
+    glFlushLastCount = 0;
+    apiRetStatus = CyU3PDmaChannelSetXfer(&glChHandleBulkLp, 0);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyFxFatalErrorHandler("CyU3PDmaChannelSetXfer", apiRetStatus, CyFalse);
+        CyU3PDmaChannelDestroy(&glChHandleBulkLp);
+        return apiRetStatus;
+    }
+
+    apiRetStatus = CyFxAppEventStartLocked();
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        CyU3PDmaChannelDestroy(&glChHandleBulkLp);
+        return apiRetStatus;
+    }
+
+    if (glStreamConfig.flushTimeoutUs != 0)
+        CyFxAppFlushTimerSet(glStreamConfig.flushTimeoutUs);
+
+    glIsApplnActive = CyTrue;
+    CyFxEventSend(CY_FX_EVENT_STREAM_START, glBulkBufferCount, usbSpeed);
+    if (isCredited)
+        CyFxEventSend(CY_FX_EVENT_CREDIT, 0, glBulkCapacity);
+    /* Events raised while the endpoint was down are waiting too */
+    CyFxEventRequestFlush();
+    CyFxTimelineMark(CY_FX_BOOT_APP_START);
+    CY_FX_LOG3(CY_FX_LOG_APP_START, glBulkBufferCount, glStreamConfig.sequence, usbSpeed);
+
+    CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Application started: %d x %d byte buffers%s, resume sequence %d\r\n",
+            glBulkBufferCount, glBulkBufferSize, isTimestamped ? " with headers" : "", glStreamConfig.sequence);
     return CY_U3P_SUCCESS;
 }
 
-CyU3PReturnStatus_t CyFxUsbAppStop(void)
+static CyU3PReturnStatus_t CyFxUsbAppStopLocked(void)
 {
+    CyU3PEpConfig_t epConfig;
+    uint32_t i;
+
+    if (!glIsApplnActive)
+        return CY_U3P_SUCCESS;
+
+    /* Tell the host while EP2 is still up and give it a few polling
+     * intervals to take the record; on a lost link this just times out */
+    CyFxEventSend(CY_FX_EVENT_STREAM_STOP, 0, 0);
+    for (i = 0; i < CY_FX_EVENT_STOP_TIMEOUT; i++)
+    {
+        CyFxAppEventFlush();
+        if (!CyFxEventPending() && (glEventConsumed == glEventCommitted))
+            break;
+        CyU3PThreadSleep(1);
+    }
+
+    glIsApplnActive = CyFalse;
+    CyFxAppFlushTimerSet(0);
+
+    CyU3PUsbFlushEp(CY_FX_EP_PRODUCER);
+    CyU3PUsbFlushEp(CY_FX_EP_CONSUMER);
+    CyU3PUsbFlushEp(CY_FX_EP_EVENT);
+
+    CyU3PDmaChannelDestroy(&glChHandleBulkLp);
+    CyU3PDmaChannelDestroy(&glChHandleEvent);
+
+    CyU3PMemSet((uint8_t *)&epConfig, 0, sizeof(epConfig));
+    epConfig.enable = CyFalse;
+    CyU3PSetEpConfig(CY_FX_EP_PRODUCER, &epConfig);
+    CyU3PSetEpConfig(CY_FX_EP_CONSUMER, &epConfig);
+    CyU3PSetEpConfig(CY_FX_EP_EVENT, &epConfig);
+
+    CY_FX_LOG(CY_FX_LOG_APP_STOP);
     CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Application stopped...\r\n");
     return CY_U3P_SUCCESS;
 }
+
+CyU3PReturnStatus_t CyFxUsbAppStart(void)
+{
+    CyU3PReturnStatus_t apiRetStatus;
+
+    CyU3PMutexGet(&glAppLock, CYU3P_WAIT_FOREVER);
+    apiRetStatus = CyFxUsbAppStartLocked();
+    CyU3PMutexPut(&glAppLock);
+    return apiRetStatus;
+}
+
+CyU3PReturnStatus_t CyFxUsbAppStop(void)
+{
+    CyU3PReturnStatus_t apiRetStatus;
+
+    CyU3PMutexGet(&glAppLock, CYU3P_WAIT_FOREVER);
+    apiRetStatus = CyFxUsbAppStopLocked();
+    CyU3PMutexPut(&glAppLock);
+    return apiRetStatus;
+}
+
+/* Bytes moved by the bulk channel since it was started, 0 if it is not running */
+uint32_t CyFxStreamGetXferCount(void)
+{
+    CyU3PDmaState_t state;
+    uint32_t prodXferCount = 0;
+    uint32_t consXferCount = 0;
+
+    CyU3PMutexGet(&glAppLock, CYU3P_WAIT_FOREVER);
+    if (glIsApplnActive)
+        CyU3PDmaChannelGetStatus(&glChHandleBulkLp, &state, &prodXferCount, &consXferCount);
+    CyU3PMutexPut(&glAppLock);
+    return consXferCount;
+}
+
+/* Cheap validation, so the setup callback can stall a bad request right away */
+CyU3PReturnStatus_t CyFxStreamCheckConfig(const CyFxStreamConfig_t *config)
+{
+    if (config->flags & ~CY_FX_STREAM_FLAGS_ALL)
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    /* The host finds the IN trailer and the frames through the header length */
+    if ((config->flags & (CY_FX_STREAM_FLAG_CRC | CY_FX_STREAM_FLAGS_CODEC))
+            && !(config->flags & CY_FX_STREAM_FLAG_TIMESTAMP))
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    if (config->bufferCount > CY_FX_BULK_BUFFER_COUNT_MAX)
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    if ((config->flushTimeoutUs != 0) && (config->flushTimeoutUs < CY_FX_FLUSH_TIMEOUT_MIN))
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    /* More buffers than arena slots would spill into the small bitmap heap */
+    if ((glFxMemMap.arenaSlots != 0) && (config->bufferCount > glFxMemMap.arenaSlots))
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    return CY_U3P_SUCCESS;
+}
+
+CyU3PReturnStatus_t CyFxStreamSetConfig(const CyFxStreamConfig_t *config)
+{
+    if (CyFxStreamCheckConfig(config) != CY_U3P_SUCCESS)
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    glStreamConfig = *config;
+
+    /* Apply the new configuration right away if the device is configured */
+    if (glIsApplnActive)
+        return CyFxUsbAppStart();
+
+    return CY_U3P_SUCCESS;
+}
+
+void CyFxStreamGetStatus(CyFxStreamStatus_t *status)
+{
+    CyU3PMemSet((uint8_t *)status, 0, sizeof(CyFxStreamStatus_t));
+    status->config     = glStreamConfig;
+    status->isActive   = glIsApplnActive;
+    status->usbSpeed   = CyU3PUsbGetSpeed();
+    status->resetCount = glUsbResetCount;
+    status->flushCount = glBulkFlushCount;
+    status->configCount  = glStreamConfigCount;
+    status->configStatus = glStreamConfigStatus;
+    if (glIsApplnActive)
+    {
+        status->bufferSize  = glBulkBufferSize;
+        status->bufferCount = glBulkBufferCount;
+    }
+}
+
+void CyFxStreamNotifyReset(void)
+{
+    glUsbResetCount++;
+}
+
+/* Reports the error counters that reached their next threshold, see cyfxevent.h */
+void CyFxStreamCheckCounters(void)
+{
+    CyFxCrcStats_t crcStats;
+
+    CyFxEventCounter(CY_FX_COUNTER_WORKER_DROP, glWorkerDropCount);
+    CyFxEventCounter(CY_FX_COUNTER_OVERRUN, glBulkOverrunCount);
+    CyFxCrcGetStats(&crcStats);
+    CyFxEventCounter(CY_FX_COUNTER_CRC_ERROR, crcStats.errors);
+}
+
+/* Posts a command to the worker. Safe from USB callbacks, never blocks.
+ * The worker prints traces at UART speed, so a burst of setup requests
+ * could fill the queue with them; traces only take the queue up to
+ * CY_FX_WORKER_QUEUE_RESERVE messages from full and are left out after
+ * that, so control commands still fit. */
+CY_FX_ITCM_CODE CyU3PReturnStatus_t CyFxAppPost(uint32_t command, const void *data, uint32_t length)
+{
+    CyFxAppMessage_t message;
+    CyU3PReturnStatus_t apiRetStatus;
+    CyBool_t isTrace = ((command == CY_FX_CMD_TRACE_REQUEST) || (command == CY_FX_CMD_TRACE_EVENT));
+    CyBool_t isTaken = CyTrue;
+    uint32_t intMask;
+
+    if (length > CY_FX_APP_MESSAGE_DATA_SIZE)
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    /* Take the slot before the send, the worker may run before it returns */
+    intMask = CyU3PVicDisableAllInterrupts();
+    if (isTrace && (glWorkerQueued >= CY_FX_WORKER_QUEUE_LENGTH - CY_FX_WORKER_QUEUE_RESERVE))
+        isTaken = CyFalse;
+    else
+        glWorkerQueued++;
+    CyU3PVicEnableInterrupts(intMask);
+
+    if (!isTaken)
+    {
+        glTraceDropCount++;
+        return CY_U3P_ERROR_QUEUE_FULL;
+    }
+
+    CyU3PMemSet((uint8_t *)&message, 0, sizeof(message));
+    message.command = command;
+    if (length != 0)
+        CyU3PMemCopy((uint8_t *)message.data, (uint8_t *)data, length);
+
+    apiRetStatus = CyU3PQueueSend(&glWorkerQueue, &message, CYU3P_NO_WAIT);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+    {
+        intMask = CyU3PVicDisableAllInterrupts();
+        glWorkerQueued--;
+        CyU3PVicEnableInterrupts(intMask);
+
+        glWorkerDropCount++;
+        CY_FX_LOG1(CY_FX_LOG_WORKER_DROP, glWorkerDropCount);
+    }
+
+    return apiRetStatus;
+}
+
+/* USB reset or disconnect. A stop must not get lost, or the channel stays
+ * up on a link that is gone. It is owed before the post, and the worker
+ * runs an owed stop before its next message: if the post fails, the full
+ * queue still holds messages received after this point. */
+CY_FX_ITCM_CODE void CyFxAppPostStop(void)
+{
+    glAppStopOwed = CyTrue;
+    CyFxAppPost(CY_FX_CMD_APP_STOP, NULL, 0);
+}
+
+void CyFxAppWorkerThreadEntry(uint32_t input)
+{
+    CyFxAppMessage_t message;
+    CyFxStreamConfig_t config;
+    uint32_t dropCount = 0;
+    uint32_t traceDropCount = 0;
+    uint32_t intMask;
+    CyU3PReturnStatus_t apiRetStatus;
+
+    while (CyTrue)
+    {
+        if (CyU3PQueueReceive(&glWorkerQueue, &message, CYU3P_WAIT_FOREVER) != CY_U3P_SUCCESS)
+            continue;
+
+        intMask = CyU3PVicDisableAllInterrupts();
+        glWorkerQueued--;
+        CyU3PVicEnableInterrupts(intMask);
+
+        /* Also covers a stop whose post was lost. It may run ahead of
+         * messages queued before it; the APP_STOP message stops again. */
+        if (glAppStopOwed)
+        {
+            glAppStopOwed = CyFalse;
+            CyFxUsbAppStop();
+        }
+
+        switch (message.command)
+        {
+        case CY_FX_CMD_APP_START:
+            CyFxUsbAppStart();
+            break;
+        case CY_FX_CMD_APP_STOP:
+            CyFxUsbAppStop();
+            break;
+        case CY_FX_CMD_STREAM_CONFIG:
+            CyU3PMemCopy((uint8_t *)&config, (uint8_t *)message.data, sizeof(config));
+            apiRetStatus = CyFxStreamSetConfig(&config);
+            if (apiRetStatus != CY_U3P_SUCCESS)
+            {
+                CY_FX_LOG1(CY_FX_LOG_STREAM_REJECTED, config.bufferCount);
+                CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Stream configuration is not applied\r\n");
+            }
+            /* The host polls the count, it must never see it without the result */
+            intMask = CyU3PVicDisableAllInterrupts();
+            glStreamConfigStatus = (uint16_t)apiRetStatus;
+            glStreamConfigCount++;
+            CyU3PVicEnableInterrupts(intMask);
+            break;
+        case CY_FX_CMD_TRACE_REQUEST:
+            CyFxUsbTraceRequest(message.data[0], message.data[1], message.data[2]);
+            break;
+        case CY_FX_CMD_TRACE_EVENT:
+            CyFxUsbTraceEvent(message.data[0], message.data[1]);
+            break;
+        case CY_FX_CMD_EVENT_FLUSH:
+            /* Drained below, together with flushes whose post was lost */
+            break;
+        case CY_FX_CMD_BULK_FLUSH:
+            CyFxAppBulkFlush();
+            break;
+        default:
+            break;
+        }
+
+        if (CyFxEventTakeFlush())
+            CyFxAppEventFlush();
+
+        if (glWorkerDropCount != dropCount)
+        {
+            dropCount = glWorkerDropCount;
+            CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Worker queue overflow: %d messages dropped\r\n", dropCount);
+        }
+
+        if (glTraceDropCount != traceDropCount)
+        {
+            traceDropCount = glTraceDropCount;
+            CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Trace backlog: %d lines left out\r\n", traceDropCount);
+        }
+    }
+}
+
+CyU3PReturnStatus_t CyFxAppWorkerCreate(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+
+    apiRetStatus = CyU3PMutexCreate(&glAppLock, CYU3P_NO_INHERIT);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        return apiRetStatus;
+
+    apiRetStatus = CyU3PQueueCreate(&glWorkerQueue, sizeof(CyFxAppMessage_t) / 4,
+            glWorkerQueueBuffer, sizeof(glWorkerQueueBuffer));
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        return apiRetStatus;
+
+    CyFxThreadMonAdd(&glWorkerThread, glWorkerStack, CY_FX_WORKER_THREAD_STACK);
+    return CyU3PThreadCreate(&glWorkerThread,    /* Worker thread structure */
+            "22:Worker thread",                 /* Thread ID and Thread name */
+            CyFxAppWorkerThreadEntry,           /* Worker thread entry function */
+            0,                                  /* No input parameter to thread */
+            glWorkerStack,                      /* Static stack, in the D-TCM if enabled */
+            CY_FX_WORKER_THREAD_STACK,          /* Thread stack size */
+            CY_FX_WORKER_THREAD_PRIORITY,       /* Thread priority */
+            CY_FX_WORKER_THREAD_PRIORITY,       /* Pre-emption threshold for the thread */
+            CYU3P_NO_TIME_SLICE,                /* No time slice for the worker thread */
+            CYU3P_AUTO_START                    /* Start the thread immediately */
+    );
+}
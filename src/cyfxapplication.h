@@ -0,0 +1,157 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXAPPLICATION_H_
+#define CYFXAPPLICATION_H_
+
+/*
+ * Stream configuration, sent by the host with the CY_FX_STREAM_REQUEST
+ * vendor request (host to device). The configuration survives USB resets,
+ * so the host can restore it after re-enumeration.
+ */
+typedef struct CyFxStreamConfig_t
+{
+    uint32_t flags;                 /* CY_FX_STREAM_FLAG_* */
+    uint16_t bufferCount;           /* Number of DMA buffers for the bulk channel, 0 = per link speed */
+    uint16_t flushTimeoutUs;        /* Send a partial bulk buffer after this long without data, 0 = never */
+    uint32_t sequence;              /* Last sequence number acknowledged by the host */
+} CyFxStreamConfig_t;
+
+#define CY_FX_STREAM_FLAG_TIMESTAMP     (0x00000001)  /* Header in front of every bulk IN buffer */
+#define CY_FX_STREAM_FLAG_CREDIT        (0x00000002)  /* Credit events for the EP1 OUT room */
+#define CY_FX_STREAM_FLAG_CRC           (0x00000004)  /* CRC-32C trailer behind every stamped IN buffer */
+#define CY_FX_STREAM_FLAG_CRC_CHECK     (0x00000008)  /* Every EP1 OUT buffer ends with a CRC-32C trailer */
+#define CY_FX_STREAM_FLAG_RLE           (0x00000010)  /* Run-length encoded IN frames, see cyfxcodec.h */
+#define CY_FX_STREAM_FLAG_DELTA16       (0x00000020)  /* 16-bit sample deltas, before RLE if both are set */
+#define CY_FX_STREAM_FLAGS_CODEC        (CY_FX_STREAM_FLAG_RLE | CY_FX_STREAM_FLAG_DELTA16)
+#define CY_FX_STREAM_FLAGS_ALL          (CY_FX_STREAM_FLAG_TIMESTAMP | CY_FX_STREAM_FLAG_CREDIT \
+                                         | CY_FX_STREAM_FLAG_CRC | CY_FX_STREAM_FLAG_CRC_CHECK \
+                                         | CY_FX_STREAM_FLAGS_CODEC)
+#define CY_FX_STREAM_FLAGS_MANUAL       (CY_FX_STREAM_FLAG_TIMESTAMP | CY_FX_STREAM_FLAG_CRC \
+                                         | CY_FX_STREAM_FLAG_CRC_CHECK | CY_FX_STREAM_FLAGS_CODEC)
+
+/*
+ * Credit flow control. With CY_FX_STREAM_FLAG_CREDIT the firmware sends
+ * CY_FX_EVENT_CREDIT on the event endpoint with the EP1 OUT payload bytes
+ * freed since the channel started and the channel capacity in bytes; the
+ * host keeps what it sends within freed + capacity. One is sent when the
+ * channel starts, then whenever another capacity / CY_FX_CREDIT_STEP_DIV
+ * bytes were freed or the channel drained. A credit still waiting for the
+ * endpoint is updated in place, so a slow poll only delays the newest one.
+ * Capacity assumes OUT transfers fill whole buffers; a short packet leaves
+ * the rest of its buffer unused and USB flow control covers the difference.
+ * Freed bytes count the payload as received, also for compressed frames.
+ */
+#define CY_FX_CREDIT_STEP_DIV           (4)
+
+/*
+ * Timestamped buffers. With CY_FX_STREAM_FLAG_TIMESTAMP the bulk channel
+ * turns manual: EP1 OUT fills each buffer after a reserved header and one
+ * packet short of the end, and the firmware fills in the header before it
+ * hands the buffer to EP1 IN. A full buffer is never a whole number of
+ * packets, so it ends the host's IN transfer with a short packet; a flushed
+ * one may fill whole packets and run into the next, the length field
+ * separates them.
+ *
+ * Stream integrity (cyfxcrc.h), also on the manual channel:
+ * CY_FX_STREAM_FLAG_CRC puts the CRC-32C of header and payload behind the
+ * payload of every stamped buffer, so it needs CY_FX_STREAM_FLAG_TIMESTAMP.
+ * With CY_FX_STREAM_FLAG_CRC_CHECK the last four bytes of every EP1 OUT
+ * buffer are the CRC-32C of the bytes before them; the host sends whole
+ * buffers and mismatches are counted (CY_FX_COUNTER_CRC_ERROR). Both cost
+ * CPU time per byte and cap the stream at the rate on the CRC stats page.
+ *
+ * Compression (cyfxcodec.h), CY_FX_STREAM_FLAG_RLE and _DELTA16, turns the
+ * payload of every stamped buffer into a frame, so both need the header
+ * too. The OUT trailer is checked before encoding, the IN trailer covers
+ * the frame. Encoding cost per byte depends on the data, see the codec
+ * stats page.
+ */
+#define CY_FX_BUFFER_HEADER_SIZE        (16)
+
+typedef struct CyFxBufferHeader_t
+{
+    uint32_t sequence;              /* Buffers produced since the channel started */
+    uint32_t length;                /* Payload bytes following the header */
+    uint32_t ticksLo;               /* CyFxTimerNow64() when the firmware saw the buffer full */
+    uint32_t ticksHi;
+} CyFxBufferHeader_t;
+
+/*
+ * Stream status, returned by the CY_FX_STREAM_REQUEST vendor request
+ * (device to host). The setup callback acks a configuration once it passed
+ * CyFxStreamCheckConfig and the worker applies it later; configCount moves
+ * on when the worker is done with it, so the host waits for that before it
+ * trusts the rest of the status.
+ */
+typedef struct CyFxStreamStatus_t
+{
+    CyFxStreamConfig_t config;      /* Active stream configuration */
+    uint8_t  isActive;              /* Whether the bulk channel is running */
+    uint8_t  usbSpeed;              /* CyU3PUSBSpeed_t of the current link */
+    uint16_t resetCount;            /* Number of USB resets since power on */
+    uint32_t flushCount;            /* Partial buffers sent by the flush timer since power on */
+    uint16_t bufferSize;            /* Bulk DMA buffer size in use, 0 while not active */
+    uint16_t bufferCount;           /* Bulk DMA buffer count in use, 0 while not active */
+    uint16_t configCount;           /* Configurations the worker handled since power on */
+    uint16_t configStatus;          /* CyU3PReturnStatus_t of the last one, 0 = applied */
+} CyFxStreamStatus_t;
+
+/*
+ * Partial buffer flush. A complex GPIO timer ticks every flushTimeoutUs and
+ * the worker wraps up the bulk producer buffer if it holds data and nothing
+ * arrived since the previous tick, so the data leaves as a short packet
+ * within one to two timeouts. Needs the bulk produce notifications.
+ */
+#define CY_FX_GPIO_FLUSH                (52)      /* Complex GPIO, the pin is not driven */
+#define CY_FX_FLUSH_TIMEOUT_MIN         (50)      /* us, shortest flushTimeoutUs accepted */
+
+/*
+ * Commands for the worker thread. USB callbacks only post these; the DMA
+ * setup and the debug output run on the worker, out of the driver context.
+ */
+typedef enum CyFxAppCommand_t
+{
+    CY_FX_CMD_APP_START = 1,        /* SET_CONFIGURATION received */
+    CY_FX_CMD_APP_STOP,             /* USB reset or disconnect */
+    CY_FX_CMD_STREAM_CONFIG,        /* data = CyFxStreamConfig_t */
+    CY_FX_CMD_TRACE_REQUEST,        /* data = setupdat0, setupdat1, isHandled */
+    CY_FX_CMD_TRACE_EVENT,          /* data = evType, evData */
+    CY_FX_CMD_EVENT_FLUSH,          /* Events queued or an event buffer freed, see cyfxevent.h */
+    CY_FX_CMD_BULK_FLUSH            /* Flush timer tick */
+} CyFxAppCommand_t;
+
+#define CY_FX_APP_MESSAGE_DATA_SIZE     (12)
+
+/* Worker queue message, four 32-bit words as required by the RTOS queue */
+typedef struct CyFxAppMessage_t
+{
+    uint32_t command;               /* CyFxAppCommand_t */
+    uint32_t data[CY_FX_APP_MESSAGE_DATA_SIZE / 4];
+} CyFxAppMessage_t;
+
+extern CyU3PReturnStatus_t CyFxAppWorkerCreate(void);
+extern CyU3PReturnStatus_t CyFxAppPost(uint32_t command, const void *data, uint32_t length);
+extern void CyFxAppPostStop(void);
+
+extern CyU3PReturnStatus_t CyFxUsbAppStart(void);
+extern CyU3PReturnStatus_t CyFxUsbAppStop(void);
+extern CyU3PReturnStatus_t CyFxStreamCheckConfig(const CyFxStreamConfig_t *config);
+extern CyU3PReturnStatus_t CyFxStreamSetConfig(const CyFxStreamConfig_t *config);
+extern void CyFxStreamGetStatus(CyFxStreamStatus_t *status);
+extern void CyFxStreamNotifyReset(void);
+extern uint32_t CyFxStreamGetXferCount(void);
+extern void CyFxStreamCheckCounters(void);
+extern void CyFxStreamFlushTick(void);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXAPPLICATION_H_ */
@@ -0,0 +1,179 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxcodec.h"
+#include "cyfxusb.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+
+uint8_t glCodecScratch[CY_FX_BULK_BUFFER_SIZE] __attribute__ ((aligned (32)));
+CyFxCodecStats_t glCodecStats;
+
+/* Writes the literals from start up to end, returns the new output position or NULL if they do not fit */
+CY_FX_ITCM_CODE static uint8_t *CyFxCodecLiterals(uint8_t *out, const uint8_t *outEnd,
+        const uint8_t *start, const uint8_t *end)
+{
+    uint32_t count;
+
+    while (start < end)
+    {
+        count = end - start;
+        if (count > 128)
+            count = 128;
+        if (out + 1 + count > outEnd)
+            return NULL;
+        *out++ = (uint8_t)(count - 1);
+        while (count-- != 0)
+            *out++ = *start++;
+    }
+    return out;
+}
+
+/* Returns the encoded length, 0 if it would reach limit */
+CY_FX_ITCM_CODE static uint32_t CyFxCodecRle(const uint8_t *in, uint32_t length, uint8_t *out, uint32_t limit)
+{
+    const uint8_t *end = in + length;
+    const uint8_t *literal = in;
+    const uint8_t *outEnd = out + limit;
+    const uint8_t *run;
+    uint8_t *start = out;
+    uint32_t count;
+
+    while (in < end)
+    {
+        run = in + 1;
+        while ((run < end) && (*run == *in) && (run - in < 130))
+            run++;
+        count = run - in;
+
+        if (count < 3)
+        {
+            in = run;
+            continue;
+        }
+
+        out = CyFxCodecLiterals(out, outEnd, literal, in);
+        if ((out == NULL) || (out + 2 > outEnd))
+            return 0;
+        *out++ = (uint8_t)(0x80 + count - 3);
+        *out++ = *in;
+        in = run;
+        literal = in;
+    }
+
+    out = CyFxCodecLiterals(out, outEnd, literal, end);
+    if ((out == NULL) || (out == outEnd))
+        return 0;
+    return out - start;
+}
+
+/* Returns the encoded length, 0 if it would reach limit. The input is 16-bit aligned. */
+CY_FX_ITCM_CODE static uint32_t CyFxCodecDelta16(const uint8_t *in, uint32_t length, uint8_t *out, uint32_t limit)
+{
+    const uint16_t *sample = (const uint16_t *)in;
+    const uint8_t *outEnd = out + limit;
+    uint8_t *start = out;
+    uint32_t i, count = length / 2;
+    uint16_t prev = 0;
+    int32_t delta;
+
+    for (i = 0; i < count; i++)
+    {
+        delta = (int16_t)(sample[i] - prev);
+        if ((delta >= -127) && (delta <= 127))
+        {
+            if (out >= outEnd)
+                return 0;
+            *out++ = (uint8_t)delta;
+        }
+        else
+        {
+            if (out + 3 > outEnd)
+                return 0;
+            *out++ = 0x80;
+            *out++ = (uint8_t)sample[i];
+            *out++ = (uint8_t)(sample[i] >> 8);
+        }
+        prev = sample[i];
+    }
+
+    if (length & 1)
+    {
+        if (out >= outEnd)
+            return 0;
+        *out++ = in[length - 1];
+    }
+    if (out == outEnd)
+        return 0;
+    return out - start;
+}
+
+/* Encodes length bytes at data in place and appends the frame trailer, the
+ * buffer has room for CY_FX_FRAME_TRAILER_SIZE more. Returns the frame length. */
+CY_FX_ITCM_CODE uint32_t CyFxCodecEncode(uint8_t *data, uint32_t length, uint8_t codec)
+{
+    uint32_t start = CyFxTimerNow();
+    uint32_t encoded = 0, runs, ticks;
+    uint8_t used = CY_FX_CODEC_STORED;
+
+    if (codec & CY_FX_CODEC_DELTA16)
+    {
+        /* Delta into the scratch buffer, then runs back into the DMA buffer.
+         * If the runs do not pay off, the deltas alone still may. */
+        encoded = CyFxCodecDelta16(data, length, glCodecScratch, length);
+        if (encoded != 0)
+        {
+            used = CY_FX_CODEC_DELTA16;
+            runs = (codec & CY_FX_CODEC_RLE) ? CyFxCodecRle(glCodecScratch, encoded, data, encoded) : 0;
+            if (runs != 0)
+            {
+                encoded = runs;
+                used |= CY_FX_CODEC_RLE;
+            }
+            else
+                CyU3PMemCopy(data, glCodecScratch, encoded);
+        }
+    }
+    else if (codec & CY_FX_CODEC_RLE)
+    {
+        encoded = CyFxCodecRle(data, length, glCodecScratch, length);
+        if (encoded != 0)
+        {
+            used = CY_FX_CODEC_RLE;
+            CyU3PMemCopy(data, glCodecScratch, encoded);
+        }
+    }
+
+    if (used == CY_FX_CODEC_STORED)
+    {
+        encoded = length;
+        glCodecStats.storedFrames++;
+    }
+
+    data[encoded]     = (uint8_t)length;
+    data[encoded + 1] = (uint8_t)(length >> 8);
+    data[encoded + 2] = used;
+    data[encoded + 3] = 0;
+    encoded += CY_FX_FRAME_TRAILER_SIZE;
+
+    ticks = CyFxTimerNow() - start;
+    glCodecStats.frames++;
+    glCodecStats.rawBytes   += length;
+    glCodecStats.frameBytes += encoded;
+    glCodecStats.ticks      += ticks;
+    if (ticks > glCodecStats.maxTicks)
+        glCodecStats.maxTicks = ticks;
+    return encoded;
+}
+
+void CyFxCodecGetStats(CyFxCodecStats_t *stats)
+{
+    *stats = glCodecStats;
+}
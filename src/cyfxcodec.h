@@ -0,0 +1,63 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXCODEC_H_
+#define CYFXCODEC_H_
+
+/*
+ * Bulk IN compression, see CY_FX_STREAM_FLAG_RLE in cyfxapplication.h.
+ * The payload of every stamped buffer becomes a frame: the encoded bytes
+ * followed by a CyFxFrameTrailer_t, and the header length covers both.
+ * A frame that would not come out smaller than the payload is stored as
+ * is, so a frame is never more than CY_FX_FRAME_TRAILER_SIZE bytes longer.
+ *
+ * CY_FX_CODEC_DELTA16 treats the payload as little-endian 16-bit samples
+ * and writes the difference to the previous sample (the first one to 0):
+ * one signed byte for -127 .. 127, else 0x80 and the sample itself. An odd
+ * last byte is copied. Slowly changing samples shrink to about half.
+ *
+ * CY_FX_CODEC_RLE, applied after DELTA16 if both are set: a control byte
+ * c < 0x80 is followed by c + 1 literal bytes, c >= 0x80 by one byte
+ * repeated c - 0x80 + 3 times.
+ *
+ * Encoding runs in the DMA callback from the I-TCM through a scratch buffer
+ * of one bulk buffer in system RAM.
+ */
+#define CY_FX_CODEC_STORED              (0x00)    /* Payload copied as is */
+#define CY_FX_CODEC_RLE                 (0x01)
+#define CY_FX_CODEC_DELTA16             (0x02)
+#define CY_FX_FRAME_TRAILER_SIZE        (4)
+
+/* Behind the encoded bytes, byte aligned */
+typedef struct CyFxFrameTrailer_t
+{
+    uint16_t rawLength;             /* Payload bytes before encoding */
+    uint8_t  codec;                 /* CY_FX_CODEC_* used for this frame */
+    uint8_t  reserved;
+} CyFxFrameTrailer_t;
+
+/* Counters since boot, all wrap; diff two reads for a rate */
+typedef struct CyFxCodecStats_t
+{
+    uint32_t frames;
+    uint32_t storedFrames;          /* Frames that did not shrink */
+    uint32_t rawBytes;              /* Payload bytes in */
+    uint32_t frameBytes;            /* Frame bytes out, trailers included */
+    uint32_t ticks;                 /* CY_FX_TIMER_HZ ticks spent encoding */
+    uint32_t maxTicks;              /* Longest frame */
+} CyFxCodecStats_t;
+
+extern uint32_t CyFxCodecEncode(uint8_t *data, uint32_t length, uint8_t codec);
+extern void CyFxCodecGetStats(CyFxCodecStats_t *stats);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXCODEC_H_ */
@@ -0,0 +1,147 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxcrc.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+
+/* glCrcTable[0] is the plain byte table, glCrcTable[k] advances a byte
+ * through k more zero bytes */
+uint32_t glCrcTable[8][256] __attribute__ ((aligned (32)));
+CyFxCrcStats_t glCrcStats;
+
+/* Builds the tables, before any stream can ask for a trailer */
+void CyFxCrcInit(void)
+{
+    uint32_t i, k, crc;
+
+    for (i = 0; i < 256; i++)
+    {
+        crc = i;
+        for (k = 0; k < 8; k++)
+            crc = (crc & 1) ? (crc >> 1) ^ CY_FX_CRC_POLY : (crc >> 1);
+        glCrcTable[0][i] = crc;
+    }
+
+    for (i = 0; i < 256; i++)
+        for (k = 1; k < 8; k++)
+            glCrcTable[k][i] = (glCrcTable[k - 1][i] >> 8) ^ glCrcTable[0][glCrcTable[k - 1][i] & 0xFF];
+}
+
+/* Continues crc over the data, 0 starts a new one */
+CY_FX_ITCM_CODE uint32_t CyFxCrc32c(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    uint32_t one, two;
+
+    crc = ~crc;
+    while ((length != 0) && ((uint32_t)data & 3))
+    {
+        crc = (crc >> 8) ^ glCrcTable[0][(crc ^ *data++) & 0xFF];
+        length--;
+    }
+
+    /* Little-endian words, the first byte sits in the low bits */
+    while (length >= 8)
+    {
+        one = *(const uint32_t *)data ^ crc;
+        two = *(const uint32_t *)(data + 4);
+        crc = glCrcTable[7][one & 0xFF] ^ glCrcTable[6][(one >> 8) & 0xFF]
+            ^ glCrcTable[5][(one >> 16) & 0xFF] ^ glCrcTable[4][one >> 24]
+            ^ glCrcTable[3][two & 0xFF] ^ glCrcTable[2][(two >> 8) & 0xFF]
+            ^ glCrcTable[1][(two >> 16) & 0xFF] ^ glCrcTable[0][two >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length-- != 0)
+        crc = (crc >> 8) ^ glCrcTable[0][(crc ^ *data++) & 0xFF];
+    return ~crc;
+}
+
+/* Reference for the benchmark, one bit per step and no table */
+static uint32_t CyFxCrc32cBitwise(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    uint32_t k;
+
+    crc = ~crc;
+    while (length-- != 0)
+    {
+        crc ^= *data++;
+        for (k = 0; k < 8; k++)
+            crc = (crc & 1) ? (crc >> 1) ^ CY_FX_CRC_POLY : (crc >> 1);
+    }
+    return ~crc;
+}
+
+/* Times both loops over the same data, the cycle counter must be running */
+void CyFxCrcBench(void)
+{
+    uint8_t *buffer;
+    uint32_t i, start, crc, ref;
+
+    buffer = (uint8_t *)CyU3PMemAlloc(CY_FX_CRC_BENCH_SIZE);
+    if (buffer == NULL)
+        return;
+    for (i = 0; i < CY_FX_CRC_BENCH_SIZE; i++)
+        buffer[i] = (uint8_t)(i * 7 + (i >> 8));
+
+    /* One untimed pass warms the cache, as a stream does */
+    CyFxCrc32c(0, buffer, CY_FX_CRC_BENCH_SIZE);
+    start = CyFxTimerNow();
+    crc = CyFxCrc32c(0, buffer, CY_FX_CRC_BENCH_SIZE);
+    glCrcStats.sliceTicks = CyFxTimerNow() - start;
+
+    start = CyFxTimerNow();
+    ref = CyFxCrc32cBitwise(0, buffer, CY_FX_CRC_BENCH_SIZE);
+    glCrcStats.bitwiseTicks = CyFxTimerNow() - start;
+
+    CyU3PMemFree(buffer);
+    glCrcStats.benchBytes = (crc == ref) ? CY_FX_CRC_BENCH_SIZE : 0;
+}
+
+/* Checks the trailer at the end of the data, length includes it */
+CY_FX_ITCM_CODE CyBool_t CyFxCrcCheck(const uint8_t *data, uint32_t length)
+{
+    const uint8_t *trailer;
+    uint32_t crc;
+
+    glCrcStats.checked++;
+    if (length < CY_FX_CRC_SIZE)
+    {
+        glCrcStats.errors++;
+        return CyFalse;
+    }
+
+    trailer = data + length - CY_FX_CRC_SIZE;
+    crc = CyFxCrc32c(0, data, length - CY_FX_CRC_SIZE);
+    if ((trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24)) != crc)
+    {
+        glCrcStats.errors++;
+        return CyFalse;
+    }
+    return CyTrue;
+}
+
+/* Writes the trailer behind length bytes of data */
+CY_FX_ITCM_CODE void CyFxCrcAppend(uint8_t *data, uint32_t length)
+{
+    uint32_t crc = CyFxCrc32c(0, data, length);
+
+    data[length]     = (uint8_t)crc;
+    data[length + 1] = (uint8_t)(crc >> 8);
+    data[length + 2] = (uint8_t)(crc >> 16);
+    data[length + 3] = (uint8_t)(crc >> 24);
+    glCrcStats.appended++;
+}
+
+void CyFxCrcGetStats(CyFxCrcStats_t *stats)
+{
+    *stats = glCrcStats;
+}
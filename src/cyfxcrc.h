@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXCRC_H_
+#define CYFXCRC_H_
+
+/*
+ * CRC-32C (Castagnoli, reflected polynomial 0x82F63B78) for the stream
+ * trailers, see CY_FX_STREAM_FLAG_CRC in cyfxapplication.h. Slice-by-8:
+ * eight bytes per step, one table load per byte. The 8 KB of tables do not
+ * fit the application half of the D-TCM, so they are built at boot in
+ * system RAM, cache line aligned; the loop itself runs from the I-TCM.
+ *
+ * CyFxCrc32c is incremental: start from 0 and feed the previous result
+ * back with the next piece of data. A trailer is the little-endian CRC of
+ * all bytes in front of it.
+ *
+ * CyFxCrcBench times the loop and a bitwise reference over the same
+ * buffer once at boot; the result and the trailer counters make up the
+ * CY_FX_STATS_PAGE_CRC page.
+ */
+#define CY_FX_CRC_POLY                  (0x82F63B78)
+#define CY_FX_CRC_SIZE                  (4)       /* Trailer bytes */
+#define CY_FX_CRC_BENCH_SIZE            (4096)    /* Bytes per timed run */
+
+typedef struct CyFxCrcStats_t
+{
+    uint32_t benchBytes;            /* CY_FX_CRC_BENCH_SIZE, 0 if the benchmark did not run */
+    uint32_t sliceTicks;            /* CY_FX_TIMER_HZ ticks for benchBytes, slice-by-8 */
+    uint32_t bitwiseTicks;          /* The same buffer one bit at a time */
+    uint32_t checked;               /* EP1 OUT buffers whose trailer was checked */
+    uint32_t errors;                /* ... and did not match */
+    uint32_t appended;              /* EP1 IN buffers given a trailer */
+} CyFxCrcStats_t;
+
+extern void CyFxCrcInit(void);
+extern void CyFxCrcBench(void);
+extern uint32_t CyFxCrc32c(uint32_t crc, const uint8_t *data, uint32_t length);
+extern CyBool_t CyFxCrcCheck(const uint8_t *data, uint32_t length);
+extern void CyFxCrcAppend(uint8_t *data, uint32_t length);
+extern void CyFxCrcGetStats(CyFxCrcStats_t *stats);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXCRC_H_ */
@@ -83,7 +83,7 @@ const uint8_t CyFxUsbSSConfigDscr[] __attribute__ ((aligned (32))) =
     /* Configuration descriptor, see p.354 */
     0x09,                           /* Descriptor size */
     CY_U3P_USB_CONFIG_DESCR,        /* Configuration descriptor type */
-    0x2C,0x00,                      /* Length of this descriptor and all sub descriptors */
+    0x39,0x00,                      /* Length of this descriptor and all sub descriptors */
     0x01,                           /* Number of interfaces */
     0x01,                           /* Configuration number */
     0x00,                           /* Configuration string index */
@@ -95,7 +95,7 @@ const uint8_t CyFxUsbSSConfigDscr[] __attribute__ ((aligned (32))) =
     CY_U3P_USB_INTRFC_DESCR,        /* Interface Descriptor type */
     0x00,                           /* Interface number */
     0x00,                           /* Alternate setting number */
-    0x02,                           /* Number of end points */
+    0x03,                           /* Number of end points */
     0xFF,                           /* Interface class */
     0x00,                           /* Interface sub class */
     0x00,                           /* Interface protocol code */
@@ -129,7 +129,22 @@ const uint8_t CyFxUsbSSConfigDscr[] __attribute__ ((aligned (32))) =
     CY_U3P_SS_EP_COMPN_DESCR,       /* SS endpoint companion descriptor type */
     (CY_FX_EP_BURST_LENGTH - 1),    /* Max no. of packets in a burst(0-15) - 0: burst 1 packet at a time */
     0x00,                           /* Max streams for bulk EP = 0 (No streams) */
-    0x00,0x00                       /* Service interval for the EP : 0 for bulk */
+    0x00,0x00,                      /* Service interval for the EP : 0 for bulk */
+
+    /* Endpoint descriptor for event EP */
+    0x07,                           /* Descriptor size */
+    CY_U3P_USB_ENDPNT_DESCR,        /* Endpoint descriptor type */
+    CY_FX_EP_EVENT,                 /* Endpoint address and description */
+    CY_U3P_USB_EP_INTR,             /* Interrupt endpoint type */
+    CY_FX_EVENT_PACKET_SIZE,0x00,   /* Max packet size = 16 bytes */
+    CY_FX_EVENT_INTERVAL,           /* Servicing interval : 125 us */
+
+    /* Super speed endpoint companion descriptor for event EP */
+    0x06,                           /* Descriptor size */
+    CY_U3P_SS_EP_COMPN_DESCR,       /* SS endpoint companion descriptor type */
+    0x00,                           /* Max no. of packets in a burst : 1 */
+    0x00,                           /* No streams for interrupt EP */
+    CY_FX_EVENT_PACKET_SIZE,0x00    /* Bytes per service interval : one event */
 };
 
 /* Standard high speed configuration descriptor */
@@ -138,7 +153,7 @@ const uint8_t CyFxUsbHSConfigDscr[] __attribute__ ((aligned (32))) =
     /* Configuration descriptor */
     0x09,                           /* Descriptor size */
     CY_U3P_USB_CONFIG_DESCR,        /* Configuration descriptor type */
-    0x20,0x00,                      /* Length of this descriptor and all sub descriptors */
+    0x27,0x00,                      /* Length of this descriptor and all sub descriptors */
     0x01,                           /* Number of interfaces */
     0x01,                           /* Configuration number */
     0x00,                           /* COnfiguration string index */
@@ -150,7 +165,7 @@ const uint8_t CyFxUsbHSConfigDscr[] __attribute__ ((aligned (32))) =
     CY_U3P_USB_INTRFC_DESCR,        /* Interface Descriptor type */
     0x00,                           /* Interface number */
     0x00,                           /* Alternate setting number */
-    0x02,                           /* Number of endpoints */
+    0x03,                           /* Number of endpoints */
     0xFF,                           /* Interface class */
     0x00,                           /* Interface sub class */
     0x00,                           /* Interface protocol code */
@@ -170,7 +185,15 @@ const uint8_t CyFxUsbHSConfigDscr[] __attribute__ ((aligned (32))) =
     CY_FX_EP_CONSUMER,              /* Endpoint address and description */
     CY_U3P_USB_EP_BULK,             /* Bulk endpoint type */
     0x00,0x02,                      /* Max packet size = 512 bytes */
-    0x00                            /* Servicing interval for data transfers : 0 for bulk */
+    0x00,                           /* Servicing interval for data transfers : 0 for bulk */
+
+    /* Endpoint descriptor for event EP */
+    0x07,                           /* Descriptor size */
+    CY_U3P_USB_ENDPNT_DESCR,        /* Endpoint descriptor type */
+    CY_FX_EP_EVENT,                 /* Endpoint address and description */
+    CY_U3P_USB_EP_INTR,             /* Interrupt endpoint type */
+    CY_FX_EVENT_PACKET_SIZE,0x00,   /* Max packet size = 16 bytes */
+    CY_FX_EVENT_INTERVAL            /* Servicing interval : 125 us */
 };
 
 /* Standard language ID string descriptor */
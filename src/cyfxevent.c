@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxevent.h"
+#include "cyfxapplication.h"
+#include "cyfxtimer.h"
+
+/* First threshold of each counter; it doubles every time it is reached */
+static const uint32_t glEventFirstThreshold[CY_FX_COUNTER_COUNT] =
+{
+    1,                              /* CY_FX_COUNTER_WORKER_DROP */
+    1,                              /* CY_FX_COUNTER_MEM_CORRUPT */
+    1000,                           /* CY_FX_COUNTER_OVERRUN, the overrun events cover the first ones */
+    1                               /* CY_FX_COUNTER_CRC_ERROR */
+};
+
+CyFxEventRecord_t glEventRing[CY_FX_EVENT_DEPTH];
+uint32_t glEventWrite = 0;              /* Records queued since boot */
+uint32_t glEventRead = 0;               /* Records sent or overwritten */
+uint32_t glEventThreshold[CY_FX_COUNTER_COUNT];
+CyBool_t glEventFlushOwed = CyFalse;    /* A flush is queued, or its post was lost */
+
+/* Queues an event and wakes the worker, never blocks */
+void CyFxEventSend(CyFxEventType_t type, uint32_t arg0, uint32_t arg1)
+{
+    uint32_t ticks = CyFxTimerNow();
+    CyFxEventRecord_t *record;
+    CyBool_t wasEmpty;
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    wasEmpty = (glEventRead == glEventWrite);
+    record = &glEventRing[(glEventWrite - 1) & (CY_FX_EVENT_DEPTH - 1)];
+
+    /* An overrun repeats every time the host falls behind, fold the repeats
+     * into the record that still waits for the endpoint. Credits are
+     * cumulative, a waiting one just takes the newest values. */
+    if ((type == CY_FX_EVENT_OVERRUN) && !wasEmpty && (record->type == CY_FX_EVENT_OVERRUN))
+        record->arg0 += arg0;
+    else if ((type == CY_FX_EVENT_CREDIT) && !wasEmpty && (record->type == CY_FX_EVENT_CREDIT))
+    {
+        record->ticks = ticks;
+        record->arg0  = arg0;
+        record->arg1  = arg1;
+    }
+    else
+    {
+        record = &glEventRing[glEventWrite & (CY_FX_EVENT_DEPTH - 1)];
+        record->type  = type;
+        record->seq   = (uint16_t)glEventWrite;
+        record->ticks = ticks;
+        record->arg0  = arg0;
+        record->arg1  = arg1;
+        glEventWrite++;
+        if (glEventWrite - glEventRead > CY_FX_EVENT_DEPTH)
+            glEventRead++;
+    }
+    CyU3PVicEnableInterrupts(intMask);
+
+    CyFxEventRequestFlush();
+}
+
+/* Wakes the worker to drain the ring unless a flush is already owed */
+void CyFxEventRequestFlush(void)
+{
+    CyBool_t wasOwed;
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    wasOwed = glEventFlushOwed;
+    glEventFlushOwed = CyTrue;
+    CyU3PVicEnableInterrupts(intMask);
+
+    /* A lost post leaves the flush owed, the worker picks it up after its
+     * next message */
+    if (!wasOwed)
+        CyFxAppPost(CY_FX_CMD_EVENT_FLUSH, NULL, 0);
+}
+
+/* Worker thread: returns whether a flush is owed and clears it, so events
+ * raised during the drain post a new one */
+CyBool_t CyFxEventTakeFlush(void)
+{
+    CyBool_t wasOwed;
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    wasOwed = glEventFlushOwed;
+    glEventFlushOwed = CyFalse;
+    CyU3PVicEnableInterrupts(intMask);
+    return wasOwed;
+}
+
+/* Reports the counter if it reached its threshold, call periodically */
+void CyFxEventCounter(CyFxEventCounter_t counter, uint32_t value)
+{
+    if (glEventThreshold[counter] == 0)
+        glEventThreshold[counter] = glEventFirstThreshold[counter];
+
+    if (value >= glEventThreshold[counter])
+    {
+        glEventThreshold[counter] = value * 2;
+        CyFxEventSend(CY_FX_EVENT_COUNTER, counter, value);
+    }
+}
+
+CyBool_t CyFxEventPending(void)
+{
+    return (glEventRead != glEventWrite);
+}
+
+/* Takes the oldest record, worker thread only */
+CyBool_t CyFxEventPop(CyFxEventRecord_t *record)
+{
+    CyBool_t isPopped = CyFalse;
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    if (glEventRead != glEventWrite)
+    {
+        *record = glEventRing[glEventRead & (CY_FX_EVENT_DEPTH - 1)];
+        glEventRead++;
+        isPopped = CyTrue;
+    }
+    CyU3PVicEnableInterrupts(intMask);
+    return isPopped;
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXEVENT_H_
+#define CYFXEVENT_H_
+
+/*
+ * Device events for the host, one CyFxEventRecord_t per packet on the
+ * CY_FX_EP_EVENT interrupt endpoint. Events are queued here from any thread
+ * or DMA callback and moved to the endpoint by the worker thread. Events
+ * raised while the endpoint is not configured wait for the next
+ * SET_CONFIGURATION. When the host does not poll, the oldest events are
+ * overwritten, which shows up as a gap in 'seq'.
+ *
+ * At most one CY_FX_CMD_EVENT_FLUSH is queued at a time. If the worker
+ * queue is full the flush stays owed and the worker drains the ring after
+ * its next message (CyFxEventTakeFlush), so no event waits for the next one.
+ */
+#define CY_FX_EVENT_DEPTH               (16)      /* Queued records, power of 2 */
+
+typedef enum CyFxEventType_t
+{
+    CY_FX_EVENT_STREAM_START = 1,   /* arg0 = bulk buffer count, arg1 = CyU3PUSBSpeed_t */
+    CY_FX_EVENT_STREAM_STOP,        /* Bulk channel about to be destroyed */
+    CY_FX_EVENT_OVERRUN,            /* All bulk buffers full, EP1 OUT is held off;
+                                       arg0 = occurrences folded into this record, arg1 = buffer count */
+    CY_FX_EVENT_DMA_ERROR,          /* Bulk channel error callback, arg0 = 0; header
+                                       commit failed, arg0 = 1, arg1 = sequence */
+    CY_FX_EVENT_COUNTER,            /* arg0 = CyFxEventCounter_t, arg1 = counter value */
+    CY_FX_EVENT_CREDIT              /* Bulk buffer room, see cyfxapplication.h; arg0 = EP1 OUT
+                                       bytes freed since the channel started, arg1 = capacity */
+} CyFxEventType_t;
+
+/* Error counters, reported each time they reach the next threshold */
+typedef enum CyFxEventCounter_t
+{
+    CY_FX_COUNTER_WORKER_DROP = 0,  /* Worker queue overflows */
+    CY_FX_COUNTER_MEM_CORRUPT,      /* Heap corruption reports */
+    CY_FX_COUNTER_OVERRUN,          /* Bulk buffer overruns */
+    CY_FX_COUNTER_CRC_ERROR,        /* EP1 OUT trailer mismatches, see cyfxcrc.h */
+    CY_FX_COUNTER_COUNT
+} CyFxEventCounter_t;
+
+typedef struct CyFxEventRecord_t
+{
+    uint16_t type;                  /* CyFxEventType_t */
+    uint16_t seq;                   /* Increments per record, gaps are lost events */
+    uint32_t ticks;                 /* CyFxTimerNow(), see cyfxtimer.h */
+    uint32_t arg0;
+    uint32_t arg1;
+} CyFxEventRecord_t;
+
+extern void CyFxEventSend(CyFxEventType_t type, uint32_t arg0, uint32_t arg1);
+extern void CyFxEventCounter(CyFxEventCounter_t counter, uint32_t value);
+extern CyBool_t CyFxEventPending(void);
+extern void CyFxEventRequestFlush(void);
+extern CyBool_t CyFxEventTakeFlush(void);
+extern CyBool_t CyFxEventPop(CyFxEventRecord_t *record);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXEVENT_H_ */
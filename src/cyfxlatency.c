@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxlatency.h"
+#include "cyfxusb.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+
+CyFxLatencyHist_t glLatency[CY_FX_LATENCY_COUNT] CY_FX_DTCM_DATA;
+
+/* Produce times of the buffers in flight. The bulk channel consumes in the
+ * order it produces, so the oldest stamp belongs to the next consume event. */
+uint32_t glLatencyDmaStamp[CY_FX_BULK_BUFFER_COUNT_MAX] CY_FX_DTCM_DATA;
+uint32_t glLatencyDmaHead = 0;          /* Stamps pushed */
+uint32_t glLatencyDmaTail = 0;          /* Stamps popped */
+
+/* Adds the time since startTicks, any context */
+CY_FX_ITCM_CODE void CyFxLatencyRecord(CyFxLatencyId_t id, uint32_t startTicks)
+{
+    CyFxLatencyHist_t *hist = &glLatency[id];
+    uint32_t ticks = CyFxTimerNow() - startTicks;
+    uint32_t bucket = (ticks != 0) ? 31 - __builtin_clz(ticks) : 0;
+    uint32_t intMask;
+
+    if (bucket >= CY_FX_LATENCY_BUCKETS)
+        bucket = CY_FX_LATENCY_BUCKETS - 1;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    hist->buckets[bucket]++;
+    hist->count++;
+    if (ticks > hist->maxTicks)
+        hist->maxTicks = ticks;
+    CyU3PVicEnableInterrupts(intMask);
+}
+
+void CyFxLatencyReset(void)
+{
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    CyU3PMemSet((uint8_t *)glLatency, 0, sizeof(glLatency));
+    CyU3PVicEnableInterrupts(intMask);
+}
+
+/* Copies all histograms into the buffer, returns the length or 0 if they do not fit */
+uint16_t CyFxLatencyGet(uint8_t *buffer, uint16_t size)
+{
+    CyFxLatencyHist_t *hist = (CyFxLatencyHist_t *)buffer;
+    uint32_t intMask;
+    uint32_t i;
+
+    if (size < sizeof(glLatency))
+        return 0;
+
+    for (i = 0; i < CY_FX_LATENCY_COUNT; i++)
+    {
+        intMask = CyU3PVicDisableAllInterrupts();
+        hist[i] = glLatency[i];
+        CyU3PVicEnableInterrupts(intMask);
+        hist[i].id          = i;
+        hist[i].bucketCount = CY_FX_LATENCY_BUCKETS;
+    }
+    return sizeof(glLatency);
+}
+
+/* Drops the stamps of a destroyed channel, call before the new one starts */
+void CyFxLatencyDmaRestart(void)
+{
+    glLatencyDmaHead = 0;
+    glLatencyDmaTail = 0;
+}
+
+/* DMA callback context, like CyFxLatencyDmaConsumed */
+CY_FX_ITCM_CODE void CyFxLatencyDmaProduced(void)
+{
+    if (glLatencyDmaHead - glLatencyDmaTail < CY_FX_BULK_BUFFER_COUNT_MAX)
+    {
+        glLatencyDmaStamp[glLatencyDmaHead % CY_FX_BULK_BUFFER_COUNT_MAX] = CyFxTimerNow();
+        glLatencyDmaHead++;
+    }
+}
+
+CY_FX_ITCM_CODE void CyFxLatencyDmaConsumed(void)
+{
+    if (glLatencyDmaHead != glLatencyDmaTail)
+    {
+        CyFxLatencyRecord(CY_FX_LATENCY_DMA, glLatencyDmaStamp[glLatencyDmaTail % CY_FX_BULK_BUFFER_COUNT_MAX]);
+        glLatencyDmaTail++;
+    }
+}
@@ -0,0 +1,52 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXLATENCY_H_
+#define CYFXLATENCY_H_
+
+/*
+ * Latency histograms on the cycle counter (cyfxtimer.h). Bucket i counts the
+ * samples of 2^i to 2^(i+1) - 1 ticks; bucket 0 also holds 0 ticks and the
+ * last bucket everything above its lower bound.
+ *
+ * Read and reset with the CY_FX_LATENCY_REQUEST vendor request:
+ *   device to host            CY_FX_LATENCY_COUNT CyFxLatencyHist_t records
+ *   host to device, no data   Clears all histograms
+ */
+#define CY_FX_LATENCY_BUCKETS           (24)      /* Last bucket: 2^23 ticks (42 ms) and above */
+#define CY_FX_LATENCY_DMA_ENABLE        (0)       /* 1 = DMA histogram, two DMA callbacks per bulk buffer */
+
+typedef enum CyFxLatencyId_t
+{
+    CY_FX_LATENCY_EP0 = 0,          /* CyFxUsbSetupCB entry to data sent, ACK or stall */
+    CY_FX_LATENCY_DMA,              /* Bulk buffer produced by EP1 OUT to consumed by EP1 IN */
+    CY_FX_LATENCY_COUNT
+} CyFxLatencyId_t;
+
+typedef struct CyFxLatencyHist_t
+{
+    uint16_t id;                    /* CyFxLatencyId_t */
+    uint16_t bucketCount;           /* CY_FX_LATENCY_BUCKETS */
+    uint32_t count;                 /* Samples since the last reset */
+    uint32_t maxTicks;
+    uint32_t buckets[CY_FX_LATENCY_BUCKETS];
+} CyFxLatencyHist_t;
+
+extern void CyFxLatencyRecord(CyFxLatencyId_t id, uint32_t startTicks);
+extern void CyFxLatencyReset(void);
+extern uint16_t CyFxLatencyGet(uint8_t *buffer, uint16_t size);
+extern void CyFxLatencyDmaRestart(void);
+extern void CyFxLatencyDmaProduced(void);
+extern void CyFxLatencyDmaConsumed(void);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXLATENCY_H_ */
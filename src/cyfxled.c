@@ -0,0 +1,64 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3error.h>
+#include <cyu3gpio.h>
+#include "cyfxled.h"
+
+/* One bit per tick, LSB first. A set bit turns the LED on (the pin is active low). */
+static const uint32_t glLedPattern[CY_FX_LED_STATUS_COUNT] =
+{
+    0x00000000,     /* Disconnected */
+    0x000001C7,     /* High speed: 150 ms on, 150 ms off, twice */
+    0x000071C7,     /* Super speed: three times */
+    0xFFFEFFFE,     /* Active */
+    0x33333333      /* Error */
+};
+
+CyU3PTimer glLedTimer;
+volatile uint8_t glLedStatus = CY_FX_LED_DISCONNECTED;
+volatile CyBool_t glLedError = CyFalse;
+uint8_t glLedPhase = 0;
+uint8_t glLedShown = CY_FX_LED_DISCONNECTED;
+
+/* Timer context: must not block */
+void CyFxLedTimerCB(uint32_t input)
+{
+    uint8_t status = glLedError ? CY_FX_LED_ERROR : glLedStatus;
+
+    /* Start a new status from the beginning of its pattern */
+    if (status != glLedShown)
+    {
+        glLedShown = status;
+        glLedPhase = 0;
+    }
+
+    CyU3PGpioSetValue(CY_FX_GPIO_LED, ((glLedPattern[status] >> glLedPhase) & 1) ? CyFalse : CyTrue);
+    glLedPhase = (glLedPhase + 1) & 31;
+}
+
+void CyFxLedSetStatus(CyFxLedStatus_t status)
+{
+    if (status < CY_FX_LED_STATUS_COUNT)
+        glLedStatus = status;
+}
+
+void CyFxLedSetError(void)
+{
+    glLedError = CyTrue;
+}
+
+CyU3PReturnStatus_t CyFxLedInit(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+
+    apiRetStatus = CyU3PTimerCreate(&glLedTimer, CyFxLedTimerCB, 0,
+            CY_FX_LED_TICK, CY_FX_LED_TICK, CYU3P_AUTO_ACTIVATE);
+    return apiRetStatus;
+}
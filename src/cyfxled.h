@@ -0,0 +1,38 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXLED_H_
+#define CYFXLED_H_
+
+#define CY_FX_GPIO_LED                  (54)
+#define CY_FX_LED_TICK                  (50)      /* Pattern step, ms */
+
+/*
+ * LED status, in increasing priority. Each status has a 32-step pattern,
+ * so one pattern cycle takes 32 * CY_FX_LED_TICK ms.
+ */
+typedef enum CyFxLedStatus_t
+{
+    CY_FX_LED_DISCONNECTED = 0,     /* Off */
+    CY_FX_LED_HIGH_SPEED,           /* Two blinks */
+    CY_FX_LED_SUPER_SPEED,          /* Three blinks */
+    CY_FX_LED_ACTIVE,               /* Data is flowing: on with a short flicker */
+    CY_FX_LED_ERROR,                /* Fast blink, sticky until reset */
+    CY_FX_LED_STATUS_COUNT
+} CyFxLedStatus_t;
+
+extern CyU3PReturnStatus_t CyFxLedInit(void);
+extern void CyFxLedSetStatus(CyFxLedStatus_t status);
+extern void CyFxLedSetError(void);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXLED_H_ */
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxlog.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+
+CyFxLogRecord_t glLogRing[CY_FX_LOG_DEPTH];
+uint32_t glLogWrite = 0;        /* Records written since boot */
+uint32_t glLogRead = 0;         /* Records read or overwritten */
+uint32_t glLogLost = 0;         /* Overwritten since the last read */
+uint32_t glLogReadEnd = 0;      /* Record after the last one CyFxLogRead copied */
+uint32_t glLogReadLost = 0;     /* glLogLost reported by CyFxLogRead */
+
+/* Any context, never blocks */
+CY_FX_ITCM_CODE void CyFxLogWrite(uint16_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2)
+{
+    uint32_t ticks = CyFxTimerNow();
+    CyFxLogRecord_t *record;
+    uint32_t intMask;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    record = &glLogRing[glLogWrite & (CY_FX_LOG_DEPTH - 1)];
+    record->id      = id;
+    record->seq     = (uint16_t)glLogWrite;
+    record->ticks   = ticks;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    glLogWrite++;
+    if (glLogWrite - glLogRead > CY_FX_LOG_DEPTH)
+    {
+        glLogRead++;
+        glLogLost++;
+    }
+    CyU3PVicEnableInterrupts(intMask);
+}
+
+/* Copies the oldest records that fit into the buffer, returns the length.
+ * The ring is left as it is until CyFxLogCommit(). */
+uint16_t CyFxLogRead(uint8_t *buffer, uint16_t size)
+{
+    CyFxLogHeader_t *header = (CyFxLogHeader_t *)buffer;
+    CyFxLogRecord_t *records = (CyFxLogRecord_t *)(buffer + sizeof(CyFxLogHeader_t));
+    uint16_t count = 0;
+    uint32_t next;
+    uint32_t intMask;
+
+    if (size < sizeof(CyFxLogHeader_t))
+        return 0;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    next = glLogRead;
+    CyU3PVicEnableInterrupts(intMask);
+
+    /* One record per critical section keeps the interrupt latency flat */
+    while (sizeof(CyFxLogHeader_t) + (count + 1) * sizeof(CyFxLogRecord_t) <= size)
+    {
+        intMask = CyU3PVicDisableAllInterrupts();
+        /* Overwritten while copying, those are counted as lost */
+        if ((int32_t)(glLogRead - next) > 0)
+            next = glLogRead;
+        if (next == glLogWrite)
+        {
+            CyU3PVicEnableInterrupts(intMask);
+            break;
+        }
+        records[count++] = glLogRing[next & (CY_FX_LOG_DEPTH - 1)];
+        next++;
+        CyU3PVicEnableInterrupts(intMask);
+    }
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    header->lost = glLogLost;
+    glLogReadLost = glLogLost;
+    glLogReadEnd = next;
+    CyU3PVicEnableInterrupts(intMask);
+
+    header->count      = count;
+    header->recordSize = sizeof(CyFxLogRecord_t);
+    return sizeof(CyFxLogHeader_t) + count * sizeof(CyFxLogRecord_t);
+}
+
+/* Drops what the last CyFxLogRead handed out, after it reached the host */
+void CyFxLogCommit(void)
+{
+    uint32_t intMask = CyU3PVicDisableAllInterrupts();
+    if ((int32_t)(glLogReadEnd - glLogRead) > 0)
+        glLogRead = glLogReadEnd;
+    glLogLost -= glLogReadLost;
+    glLogReadLost = 0;
+    CyU3PVicEnableInterrupts(intMask);
+}
@@ -0,0 +1,59 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXLOG_H_
+#define CYFXLOG_H_
+
+#include "cyfxlogmsg.h"
+
+/*
+ * Deferred binary log. A record holds a message ID, the cycle counter and
+ * the raw arguments; formatting is left to the host. Writing a record takes
+ * a fraction of a microsecond and is safe from any context, so it can be
+ * used where CyU3PDebugPrint is far too slow.
+ *
+ * The host drains the ring with the CY_FX_LOG_REQUEST vendor request
+ * (device to host). Each read returns a CyFxLogHeader_t followed by the
+ * oldest records; they and the lost count are removed from the ring only
+ * by CyFxLogCommit() once the EP0 data phase succeeded, so a failed read
+ * hands the same records out again. The read itself is not logged. When
+ * the ring overflows the oldest records are overwritten and counted in
+ * 'lost'.
+ */
+#define CY_FX_LOG_DEPTH                 (128)     /* Records, power of 2 */
+
+typedef struct CyFxLogRecord_t
+{
+    uint16_t id;                    /* CyFxLogId_t */
+    uint16_t seq;                   /* Low 16 bits of the record number */
+    uint32_t ticks;                 /* CyFxTimerNow(), see cyfxtimer.h */
+    uint32_t args[3];
+} CyFxLogRecord_t;
+
+typedef struct CyFxLogHeader_t
+{
+    uint32_t lost;                  /* Records overwritten since the previous read */
+    uint16_t count;                 /* Records following the header */
+    uint16_t recordSize;            /* Bytes per record */
+} CyFxLogHeader_t;
+
+#define CY_FX_LOG(id)                   CyFxLogWrite((id), 0, 0, 0)
+#define CY_FX_LOG1(id, a0)              CyFxLogWrite((id), (uint32_t)(a0), 0, 0)
+#define CY_FX_LOG2(id, a0, a1)          CyFxLogWrite((id), (uint32_t)(a0), (uint32_t)(a1), 0)
+#define CY_FX_LOG3(id, a0, a1, a2)      CyFxLogWrite((id), (uint32_t)(a0), (uint32_t)(a1), (uint32_t)(a2))
+
+extern void CyFxLogWrite(uint16_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+extern uint16_t CyFxLogRead(uint8_t *buffer, uint16_t size);
+extern void CyFxLogCommit(void);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXLOG_H_ */
@@ -0,0 +1,40 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#ifndef CYFXLOGMSG_H_
+#define CYFXLOGMSG_H_
+
+/*
+ * Binary log message table, shared with the host decoder (libfx3link/fx3log.cpp).
+ * The firmware only expands the IDs, so the format strings never reach the
+ * device image; the host compiles them into its string table. Formats take
+ * up to three 32-bit arguments: %u, %d, %x and %08x only.
+ *
+ * Append new messages at the end, the IDs are part of the wire format.
+ * This file must not include any SDK header.
+ */
+#define CY_FX_LOG_MESSAGES(X) \
+    X(CY_FX_LOG_BOOT,               "Firmware started, API %u.%u.%u") \
+    X(CY_FX_LOG_FATAL,              "Fatal error %d, called from 0x%08x") \
+    X(CY_FX_LOG_APP_START,          "Application started: %u buffers, resume sequence %u, USB speed %u") \
+    X(CY_FX_LOG_APP_STOP,           "Application stopped") \
+    X(CY_FX_LOG_USB_SETUP,          "Setup request 0x%08x 0x%08x, handled %u") \
+    X(CY_FX_LOG_USB_EVENT,          "USB event %u, data %u") \
+    X(CY_FX_LOG_WORKER_DROP,        "Worker queue overflow: %u messages dropped") \
+    X(CY_FX_LOG_MEM_CORRUPT,        "Memory corruption detected at 0x%08x") \
+    X(CY_FX_LOG_STREAM_REJECTED,    "Stream configuration is not applied: %u buffers")
+
+#define CY_FX_LOG_ENUM_ENTRY(id, format) id,
+
+typedef enum CyFxLogId_t
+{
+    CY_FX_LOG_MESSAGES(CY_FX_LOG_ENUM_ENTRY)
+    CY_FX_LOG_ID_COUNT
+} CyFxLogId_t;
+
+#endif /* CYFXLOGMSG_H_ */
@@ -13,18 +13,37 @@
 #include <cyu3gpio.h>
 #include <cyu3usb.h>
 #include "cyfxdebug.h"
+#include "cyfxapplication.h"
+#include "cyfxled.h"
+#include "cyfxmempool.h"
+#include "cyfxtx.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+#include "cyfxlog.h"
+#include "cyfxprofile.h"
+#include "cyfxthreadmon.h"
+#include "cyfxevent.h"
+#include "cyfxcrc.h"
 
 #define CY_FX_APP_THREAD_STACK      (0x1000)
 #define CY_FX_APP_THREAD_PRIORITY   (8)
-#define CY_FX_GPIO_LED              (54)
+#define CY_FX_HOUSEKEEPING_PERIOD   (100)   /* ms */
 
 extern CyU3PReturnStatus_t CyFxUsbInit(void);
+extern uint32_t glUsbTraceEarlyCount;
+
+volatile CyBool_t glDebugReady = CyFalse;  /* The UART debug output is up */
 
 CyU3PThread appThread;
+uint32_t glLastXferCount = 0;   /* Bulk channel byte count at the previous housekeeping pass */
+void * volatile glMemCorruptBlock = NULL;   /* Last corrupted block reported by the allocators */
+uint32_t glMemCorruptCount = 0;             /* Corruption reports seen by the housekeeping */
 
 void CyFxFatalErrorHandler(const char* msg, CyU3PReturnStatus_t status, CyBool_t noReturn)
 {
+    CY_FX_LOG2(CY_FX_LOG_FATAL, status, __builtin_return_address(0));
     CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "FATAL ERROR: %s (%d)\r\n", msg, status);
+    CyFxLedSetError();
     if (noReturn)
         while (CyTrue)
             CyU3PThreadSleep(100);
@@ -37,12 +56,17 @@ void CyFxGetSysInfo(void)
     uint16_t patchNumer = 0;
     uint16_t buildNumer = 0;
     CyU3PSysGetApiVersion(&majorVersion, &minorVersion, &patchNumer, &buildNumer);
+    CY_FX_LOG3(CY_FX_LOG_BOOT, majorVersion, minorVersion, patchNumer);
     CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "FX3 API version: %d.%d.%d.%d\r\n",
             majorVersion, minorVersion, patchNumer, buildNumer);
 
     uint32_t clkFreq = 0;
     CyU3PDeviceGetSysClkFreq(&clkFreq);
     CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Current SYS_CLK frequency: %d Hz\r\n", clkFreq);
+
+    CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Memory profile %d: driver heap %d KB, buffer heap %d KB, DMA arena %d x %d bytes\r\n",
+            glFxMemMap.profile, glFxMemMap.memHeapSize >> 10, glFxMemMap.bufferHeapSize >> 10,
+            glFxMemMap.arenaSlots, glFxMemMap.arenaSlotSize);
 }
 
 CyU3PReturnStatus_t CyFxDebugInit(void)
@@ -83,6 +107,15 @@ CyU3PReturnStatus_t CyFxDebugInit(void)
     return CY_U3P_SUCCESS;
 }
 
+/* GPIO interrupt callback, interrupt context */
+void CyFxGpioIntrCB(uint8_t gpioId)
+{
+    if (gpioId == CY_FX_GPIO_PROFILE)
+        CyFxProfileTick();
+    else if (gpioId == CY_FX_GPIO_FLUSH)
+        CyFxStreamFlushTick();
+}
+
 CyU3PReturnStatus_t CyFxGpioInit(void)
 {
     CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
@@ -95,7 +128,7 @@ CyU3PReturnStatus_t CyFxGpioInit(void)
     gpioClock.simpleDiv  = CY_U3P_GPIO_SIMPLE_DIV_BY_2;
     gpioClock.clkSrc     = CY_U3P_SYS_CLK;
     gpioClock.halfDiv    = 0;
-    apiRetStatus = CyU3PGpioInit (&gpioClock, NULL);
+    apiRetStatus = CyU3PGpioInit (&gpioClock, CyFxGpioIntrCB);
     if (apiRetStatus != CY_U3P_SUCCESS)
         return apiRetStatus;
 
@@ -110,61 +143,116 @@ CyU3PReturnStatus_t CyFxGpioInit(void)
     gpioConfig.inputEn = CyFalse;
     gpioConfig.intrMode = CY_U3P_GPIO_NO_INTR;
     apiRetStatus = CyU3PGpioSetSimpleConfig(CY_FX_GPIO_LED, &gpioConfig);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        return apiRetStatus;
+
+    /* Cycle counter for the callback timings */
+    apiRetStatus = CyFxTimerInit();
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        return apiRetStatus;
+
+    /* Profiler tick, without sampling it only feeds the thread monitor */
+    apiRetStatus = CyFxProfileStart(0);
     if (apiRetStatus != CY_U3P_SUCCESS)
         return apiRetStatus;
 
 	return CY_U3P_SUCCESS;
 }
 
+/* Allocator corruption callback, may run in any context: only record the block */
+void CyFxMemCorruptCB(void *block)
+{
+    glMemCorruptBlock = block;
+    CY_FX_LOG1(CY_FX_LOG_MEM_CORRUPT, block);
+    CyFxLedSetError();
+}
+
+/* Link state and activity for the LED engine, incremental heap check */
+void CyFxHousekeeping(void)
+{
+    uint32_t xferCount = CyFxStreamGetXferCount();
+    CyFxLedStatus_t status;
+    void *block;
+
+    CyFxMemCheckStep(CY_FX_MEM_CHECK_BLOCKS);
+    block = glMemCorruptBlock;
+    if (block != NULL)
+    {
+        glMemCorruptBlock = NULL;
+        glMemCorruptCount++;
+        CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Memory corruption detected at 0x%x\r\n", (uint32_t)block);
+    }
+
+    CyFxEventCounter(CY_FX_COUNTER_MEM_CORRUPT, glMemCorruptCount);
+    CyFxStreamCheckCounters();
+
+    /* Keeps the 64-bit timer extension in step with the wraps */
+    CyFxTimerNow64();
+
+    switch (CyU3PUsbGetSpeed())
+    {
+    case CY_U3P_SUPER_SPEED:
+        status = CY_FX_LED_SUPER_SPEED;
+        break;
+    case CY_U3P_HIGH_SPEED:
+        status = CY_FX_LED_HIGH_SPEED;
+        break;
+    default:
+        status = CY_FX_LED_DISCONNECTED;
+        break;
+    }
+
+    if ((status != CY_FX_LED_DISCONNECTED) && (xferCount != glLastXferCount))
+        status = CY_FX_LED_ACTIVE;
+    glLastXferCount = xferCount;
+
+    CyFxLedSetStatus(status);
+}
+
 /* Thread entry point */
 void CyFxAppThreadEntry(uint32_t input)
 {
-	uint8_t i = 0;
     CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
 
+    /* GPIO first: it starts the cycle counter for the boot timeline */
+    apiRetStatus = CyFxGpioInit();
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        CyFxFatalErrorHandler("CyFxGpioInit", apiRetStatus, CyTrue);
+    CyFxTimelineMark(CY_FX_BOOT_GPIO_INIT);
+
+    apiRetStatus = CyFxLedInit();
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        CyFxFatalErrorHandler("CyFxLedInit", apiRetStatus, CyFalse);
+
+    /* Connect as early as possible, logging is not needed for enumeration.
+     * The price: the UART is not up yet, so the first USB traces are not
+     * posted (only counted) and a print from the USB path, a fatal error
+     * in CyFxUsbInit included, goes nowhere. All of them are still in the
+     * binary log, and a fatal error also shows on the LED. */
+    CyFxUsbInit();
+
     /* Initialize the debug module */
     apiRetStatus = CyFxDebugInit();
     if (apiRetStatus != CY_U3P_SUCCESS)
         CyFxFatalErrorHandler("CyFxDebugInit", apiRetStatus, CyTrue);
-
-    apiRetStatus = CyFxGpioInit();
-    if (apiRetStatus != CY_U3P_SUCCESS)
-        CyFxFatalErrorHandler("CyFxGpioInit", apiRetStatus, CyTrue);
+    glDebugReady = CyTrue;
+    CyFxTimelineMark(CY_FX_BOOT_DEBUG_INIT);
 
     CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "\r\n");
+    if (glUsbTraceEarlyCount != 0)
+        CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "%d USB traces before debug init, see the binary log\r\n",
+                glUsbTraceEarlyCount);
 
     CyFxGetSysInfo();
 
-    CyFxUsbInit();
+    /* Needs the cycle counter, and is done before the host asks for the page */
+    CyFxCrcBench();
 
-    /* Main loop */
+    /* Housekeeping loop, the LED itself is driven by the LED timer */
     while (CyTrue)
     {
-    	CyU3PUSBSpeed_t usbSpeed = CyU3PUsbGetSpeed();
-    	switch (usbSpeed)
-    	{
-    	case CY_U3P_SUPER_SPEED:
-    		for (i = 0; i < 3; i++) {
-    	    	CyU3PGpioSetValue(CY_FX_GPIO_LED, CyFalse);
-    	    	CyU3PThreadSleep(150);
-    	    	CyU3PGpioSetValue(CY_FX_GPIO_LED, CyTrue);
-    	    	CyU3PThreadSleep(150);
-    		}
-        	CyU3PThreadSleep(1100);
-        	break;
-    	case CY_U3P_HIGH_SPEED:
-    		for (i = 0; i < 2; i++) {
-    	    	CyU3PGpioSetValue(CY_FX_GPIO_LED, CyFalse);
-    	    	CyU3PThreadSleep(150);
-    	    	CyU3PGpioSetValue(CY_FX_GPIO_LED, CyTrue);
-    	    	CyU3PThreadSleep(150);
-    		}
-        	CyU3PThreadSleep(1400);
-        	break;
-    	default:
-        	CyU3PGpioSetValue(CY_FX_GPIO_LED, CyTrue);
-    		break;
-    	}
+        CyFxHousekeeping();
+        CyU3PThreadSleep(CY_FX_HOUSEKEEPING_PERIOD);
     }
 }
 
@@ -174,10 +262,16 @@ void CyFxApplicationDefine(void)
     void *ptr = NULL;
     uint32_t retThrdCreate = CY_U3P_SUCCESS;
 
+    /* Carve the block pools out of the driver heap before anything else fragments it */
+    if (CyFxMemPoolInit() != CY_U3P_SUCCESS)
+        while (CyTrue);
+
     /* Allocate the memory for the threads */
     ptr = CyU3PMemAlloc(CY_FX_APP_THREAD_STACK);
 
     if (ptr != NULL) {
+        CyFxThreadMonAdd(&appThread, ptr, CY_FX_APP_THREAD_STACK);
+
         /* Create the thread for the application */
         retThrdCreate = CyU3PThreadCreate (&appThread,  /* Application thread structure */
                 "21:Application thread",                /* Thread ID and Thread name */
@@ -192,6 +286,17 @@ void CyFxApplicationDefine(void)
         );
     }
 
+    /* Trailer tables, before the worker can start a stream that uses them */
+    CyFxCrcInit();
+
+    /* Create the data and control worker */
+    if (retThrdCreate == CY_U3P_SUCCESS)
+        retThrdCreate = CyFxAppWorkerCreate();
+
+    /* Create the profiler sampler, it stays idle until started by the host */
+    if (retThrdCreate == CY_U3P_SUCCESS)
+        retThrdCreate = CyFxProfileInit();
+
     /* Check the return code */
     if (retThrdCreate != CY_U3P_SUCCESS)
     {
@@ -216,6 +321,17 @@ int main (void)
     clkConfig.useStandbyClk = CyFalse;  /* device has no 32KHz clock supplied */
     clkConfig.clkSrc = CY_U3P_SYS_CLK;  /* Clock source for a peripheral block  */
 
+    /* D-TCM data is not part of the BSS */
+    CyFxDtcmInit();
+    CyFxTimelineMark(CY_FX_BOOT_MAIN);
+
+    /* Allocator leak and corruption checks must be enabled before the heaps are set up */
+    if (CY_FX_MEM_CHECK_ENABLE)
+    {
+        CyU3PMemEnableChecks(CyTrue, CyFxMemCorruptCB);
+        CyU3PBufEnableChecks(CyTrue, CyFxMemCorruptCB);
+    }
+
     /* Initialize the device */
     apiRetStatus = CyU3PDeviceInit(&clkConfig);
     if (apiRetStatus != CY_U3P_SUCCESS)
@@ -225,6 +341,7 @@ int main (void)
     apiRetStatus = CyU3PDeviceCacheControl(CyTrue, CyTrue, CyTrue);
     if (apiRetStatus != CY_U3P_SUCCESS)
         goto fatalErrorHandler;
+    CyFxTimelineMark(CY_FX_BOOT_DEVICE_INIT);
 
     /* Configure the IO matrix for the device. On the FX3 DVK board, the COM port
      * is connected to the IO(53:56). This means that either DQ32 mode should be
@@ -233,10 +350,13 @@ int main (void)
     ioConfig.isDQ32Bit  = CyTrue;
     ioConfig.useUart    = CyTrue;
     ioConfig.lppMode    = CY_U3P_IO_MATRIX_LPP_DEFAULT;
+    ioConfig.gpioComplexEn[1] = (1 << (CY_FX_GPIO_TIMER - 32)) | (1 << (CY_FX_GPIO_PROFILE - 32))
+            | (1 << (CY_FX_GPIO_FLUSH - 32));
 
     apiRetStatus = CyU3PDeviceConfigureIOMatrix(&ioConfig);
     if (apiRetStatus != CY_U3P_SUCCESS)
         goto fatalErrorHandler;
+    CyFxTimelineMark(CY_FX_BOOT_IO_MATRIX);
 
     /* This is a non returnable call for initializing the RTOS kernel */
     CyU3PKernelEntry();
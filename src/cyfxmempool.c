@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include <cyu3error.h>
+#include "cyfxmempool.h"
+
+/* ThreadX keeps a pointer in front of every block */
+#define CY_FX_MEMPOOL_BLOCK_OVERHEAD    (sizeof(void *))
+
+/* Pool sizes: message structs, descriptors and command frames, smallest first */
+static const uint16_t glMemPoolConfig[CY_FX_MEMPOOL_COUNT][2] =
+{
+    /* Block size, block count */
+    {  32, 32 },
+    {  64, 16 },
+    { 256,  8 }
+};
+
+CyU3PBlockPool glMemPool[CY_FX_MEMPOOL_COUNT];
+CyBool_t glMemPoolReady = CyFalse;              /* Set once all pools exist */
+uint8_t *glMemPoolStart[CY_FX_MEMPOOL_COUNT];   /* Pool memory, used to find the pool of a block */
+uint8_t *glMemPoolEnd[CY_FX_MEMPOOL_COUNT];
+CyFxMemPoolStats_t glMemPoolStats[CY_FX_MEMPOOL_COUNT];
+
+CyU3PReturnStatus_t CyFxMemPoolInit(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+    uint32_t poolSize;
+    uint8_t i;
+
+    for (i = 0; i < CY_FX_MEMPOOL_COUNT; i++)
+    {
+        poolSize = (glMemPoolConfig[i][0] + CY_FX_MEMPOOL_BLOCK_OVERHEAD) * glMemPoolConfig[i][1];
+
+        glMemPoolStart[i] = (uint8_t *)CyU3PMemAlloc(poolSize);
+        if (glMemPoolStart[i] == NULL)
+            return CY_U3P_ERROR_MEMORY_ERROR;
+        glMemPoolEnd[i] = glMemPoolStart[i] + poolSize;
+
+        apiRetStatus = CyU3PBlockPoolCreate(&glMemPool[i], glMemPoolConfig[i][0], glMemPoolStart[i], poolSize);
+        if (apiRetStatus != CY_U3P_SUCCESS)
+            return apiRetStatus;
+
+        CyU3PMemSet((uint8_t *)&glMemPoolStats[i], 0, sizeof(CyFxMemPoolStats_t));
+        glMemPoolStats[i].blockSize  = glMemPoolConfig[i][0];
+        glMemPoolStats[i].blockCount = glMemPoolConfig[i][1];
+    }
+
+    glMemPoolReady = CyTrue;
+    return CY_U3P_SUCCESS;
+}
+
+void *CyFxMemPoolAlloc(uint32_t size)
+{
+    void *ptr = NULL;
+    uint32_t intMask;
+    uint8_t i;
+
+    /* CyU3PMemAlloc calls in here from the start, the pools come later */
+    if (!glMemPoolReady)
+        return NULL;
+
+    for (i = 0; i < CY_FX_MEMPOOL_COUNT; i++)
+    {
+        if (size > glMemPoolConfig[i][0])
+            continue;
+
+        /* Fall through to a larger pool if this one is empty */
+        if (CyU3PBlockAlloc(&glMemPool[i], &ptr, CYU3P_NO_WAIT) == CY_U3P_SUCCESS)
+        {
+            intMask = CyU3PVicDisableAllInterrupts();
+            glMemPoolStats[i].allocCount++;
+            if (++glMemPoolStats[i].inUse > glMemPoolStats[i].peak)
+                glMemPoolStats[i].peak = glMemPoolStats[i].inUse;
+            CyU3PVicEnableInterrupts(intMask);
+            return ptr;
+        }
+
+        intMask = CyU3PVicDisableAllInterrupts();
+        glMemPoolStats[i].failCount++;
+        CyU3PVicEnableInterrupts(intMask);
+    }
+
+    return NULL;
+}
+
+CyBool_t CyFxMemPoolFree(void *ptr)
+{
+    uint32_t intMask;
+    uint8_t i;
+
+    for (i = 0; i < CY_FX_MEMPOOL_COUNT; i++)
+    {
+        if (((uint8_t *)ptr >= glMemPoolStart[i]) && ((uint8_t *)ptr < glMemPoolEnd[i]))
+        {
+            CyU3PBlockFree(ptr);
+
+            intMask = CyU3PVicDisableAllInterrupts();
+            glMemPoolStats[i].inUse--;
+            CyU3PVicEnableInterrupts(intMask);
+            return CyTrue;
+        }
+    }
+
+    return CyFalse;
+}
+
+void CyFxMemPoolGetStats(CyFxMemPoolStats_t *stats)
+{
+    uint32_t intMask = CyU3PVicDisableAllInterrupts();
+    CyU3PMemCopy((uint8_t *)stats, (uint8_t *)glMemPoolStats, sizeof(glMemPoolStats));
+    CyU3PVicEnableInterrupts(intMask);
+}
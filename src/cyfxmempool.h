@@ -0,0 +1,43 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXMEMPOOL_H_
+#define CYFXMEMPOOL_H_
+
+/*
+ * Fixed-size block pools carved out of the driver heap once at boot. Alloc
+ * and free are O(1), never wait and may be called from interrupt context.
+ * A request is served by the smallest pool whose blocks are large enough.
+ * CyU3PMemAlloc (cyfxtx.c) takes every request that fits a pool from here,
+ * SDK allocations included, and falls back to the byte pool when none has
+ * a free block.
+ */
+#define CY_FX_MEMPOOL_COUNT             (3)
+
+/* Usage counters of one pool, also the wire format of the stats page */
+typedef struct CyFxMemPoolStats_t
+{
+    uint16_t blockSize;             /* Bytes per block */
+    uint16_t blockCount;            /* Blocks in the pool */
+    uint16_t inUse;                 /* Blocks allocated right now */
+    uint16_t peak;                  /* Highest inUse since boot */
+    uint32_t allocCount;            /* Successful allocations */
+    uint32_t failCount;             /* Allocations refused because the pool was empty */
+} CyFxMemPoolStats_t;
+
+extern CyU3PReturnStatus_t CyFxMemPoolInit(void);
+extern void *CyFxMemPoolAlloc(uint32_t size);
+extern CyBool_t CyFxMemPoolFree(void *ptr);     /* CyFalse if ptr is not a pool block */
+extern void CyFxMemPoolGetStats(CyFxMemPoolStats_t *stats);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXMEMPOOL_H_ */
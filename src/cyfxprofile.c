@@ -0,0 +1,253 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include <cyu3error.h>
+#include <cyu3gpio.h>
+#include "cyfxprofile.h"
+#include "cyfxtimer.h"
+#include "cyfxthreadmon.h"
+
+#define CY_FX_PROFILE_THREAD_STACK      (0x400)
+#define CY_FX_PROFILE_THREAD_PRIORITY   (2)       /* Above the SDK driver threads */
+#define CY_FX_PROFILE_EVENT_TICK        (1 << 0)
+
+/*
+ * ThreadX ARM9 port: a thread preempted by an interrupt has this frame at
+ * tx_thread_stack_ptr (see tx_thread_stack_build.s): type 1, CPSR, r0-r12,
+ * lr, pc. A thread that suspended itself has a type 0 frame without the pc.
+ */
+#define CY_FX_TX_INT_FRAME_TYPE         (1)
+#define CY_FX_TX_INT_FRAME_PC           (16)
+#define CY_FX_TX_INT_FRAME_WORDS        (17)
+
+typedef struct CyFxProfileThreadSlot_t
+{
+    CyU3PThread *thread;
+    CyFxProfileThread_t stats;
+} CyFxProfileThreadSlot_t;
+
+CyU3PThread glProfileThread;
+CyU3PEvent glProfileEvent;
+uint8_t glProfileStack[CY_FX_PROFILE_THREAD_STACK] __attribute__ ((aligned (8)));
+
+CyFxProfileSummary_t glProfile;
+CyFxProfileThreadSlot_t glProfileThreads[CY_FX_PROFILE_THREADS];
+CyFxProfilePc_t glProfilePc[CY_FX_PROFILE_PC_SLOTS];
+CyU3PThread * volatile glProfileSampled = NULL;     /* Interrupted thread, set by the tick */
+volatile CyBool_t glProfilePending = CyFalse;       /* A tick waits for the sampler thread */
+uint32_t glProfilePeriodUs = 0;                     /* Tick period, 0 until the timer runs */
+
+/* Program counter of a thread preempted by an interrupt, 0 if unknown */
+static uint32_t CyFxProfileThreadPc(CyU3PThread *thread)
+{
+    uint32_t *frame = (uint32_t *)thread->tx_thread_stack_ptr;
+
+    if ((frame < (uint32_t *)thread->tx_thread_stack_start)
+            || (frame + CY_FX_TX_INT_FRAME_WORDS > (uint32_t *)thread->tx_thread_stack_end)
+            || (frame[0] != CY_FX_TX_INT_FRAME_TYPE))
+        return 0;
+
+    return frame[CY_FX_TX_INT_FRAME_PC];
+}
+
+static void CyFxProfileAddThread(CyU3PThread *thread)
+{
+    CyFxProfileThreadSlot_t *slot;
+    uint32_t i, j;
+
+    for (i = 0; i < glProfile.threadCount; i++)
+    {
+        if (glProfileThreads[i].thread == thread)
+        {
+            glProfileThreads[i].stats.count++;
+            return;
+        }
+    }
+
+    if (glProfile.threadCount == CY_FX_PROFILE_THREADS)
+        return;
+
+    slot = &glProfileThreads[glProfile.threadCount];
+    slot->thread = thread;
+    for (j = 0; (j < CY_FX_PROFILE_THREAD_NAME - 1) && thread->tx_thread_name && thread->tx_thread_name[j]; j++)
+        slot->stats.name[j] = thread->tx_thread_name[j];
+    slot->stats.name[j] = 0;
+    slot->stats.count = 1;
+    glProfile.threadCount++;
+}
+
+static void CyFxProfileAddPc(uint32_t pc)
+{
+    uint32_t slot = (pc >> 2) & (CY_FX_PROFILE_PC_SLOTS - 1);
+    uint32_t i;
+
+    for (i = 0; i < CY_FX_PROFILE_PC_SLOTS; i++)
+    {
+        CyFxProfilePc_t *entry = &glProfilePc[(slot + i) & (CY_FX_PROFILE_PC_SLOTS - 1)];
+        if (entry->pc == pc)
+        {
+            entry->count++;
+            return;
+        }
+        if (entry->pc == 0)
+        {
+            entry->pc = pc;
+            entry->count = 1;
+            return;
+        }
+    }
+
+    glProfile.pcOverflow++;
+}
+
+void CyFxProfileThreadEntry(uint32_t input)
+{
+    CyU3PThread *thread;
+    uint32_t flags;
+    uint32_t pc;
+
+    while (CyTrue)
+    {
+        if (CyU3PEventGet(&glProfileEvent, CY_FX_PROFILE_EVENT_TICK, CYU3P_EVENT_OR_CLEAR,
+                &flags, CYU3P_WAIT_FOREVER) != CY_U3P_SUCCESS)
+            continue;
+
+        /* Nothing ran since the tick except interrupts and higher priority
+         * threads, so the sampled thread is still in its preempted state */
+        thread = glProfileSampled;
+        glProfile.samples++;
+        if (thread == NULL)
+            glProfile.idle++;
+        else
+        {
+            CyFxProfileAddThread(thread);
+            pc = (thread == &glProfileThread) ? 0 : CyFxProfileThreadPc(thread);
+            if (pc != 0)
+                CyFxProfileAddPc(pc);
+            else
+                glProfile.unknownPc++;
+        }
+        glProfilePending = CyFalse;
+    }
+}
+
+/* GPIO interrupt context */
+void CyFxProfileTick(void)
+{
+    CyFxThreadMonTick(glProfilePeriodUs);
+    if (glProfile.rateHz == 0)
+        return;
+
+    if (glProfilePending)
+    {
+        glProfile.missed++;
+        return;
+    }
+
+    glProfileSampled = CyU3PThreadIdentify();
+    glProfilePending = CyTrue;
+    CyU3PEventSet(&glProfileEvent, CY_FX_PROFILE_EVENT_TICK, CYU3P_EVENT_OR);
+}
+
+static CyU3PReturnStatus_t CyFxProfileSetTimer(uint16_t rateHz)
+{
+    CyU3PGpioComplexConfig_t gpioConfig;
+
+    CyU3PMemSet((uint8_t *)&gpioConfig, 0, sizeof(gpioConfig));
+    gpioConfig.pinMode   = CY_U3P_GPIO_MODE_STATIC;
+    gpioConfig.intrMode  = CY_U3P_GPIO_INTR_TIMER_ZERO;
+    gpioConfig.timerMode = CY_U3P_GPIO_TIMER_HIGH_FREQ;
+    gpioConfig.timer     = 0;
+    gpioConfig.period    = CY_FX_TIMER_HZ / rateHz;
+    gpioConfig.threshold = gpioConfig.period;
+    glProfilePeriodUs = 1000000 / rateHz;
+    return CyU3PGpioSetComplexConfig(CY_FX_GPIO_PROFILE, &gpioConfig);
+}
+
+/* Clears the histograms and starts sampling at rateHz. 0 stops the sampling,
+ * the timer then keeps ticking at CY_FX_THREAD_MON_RATE for the load figures. */
+CyU3PReturnStatus_t CyFxProfileStart(uint16_t rateHz)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+
+    if (rateHz > CY_FX_PROFILE_RATE_MAX)
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    /* The sampler thread is idle once the ticks stop waking it */
+    glProfile.rateHz = 0;
+    if (rateHz == 0)
+        return CyFxProfileSetTimer(CY_FX_THREAD_MON_RATE);
+
+    CyU3PMemSet((uint8_t *)&glProfile, 0, sizeof(glProfile));
+    CyU3PMemSet((uint8_t *)glProfileThreads, 0, sizeof(glProfileThreads));
+    CyU3PMemSet((uint8_t *)glProfilePc, 0, sizeof(glProfilePc));
+    glProfilePending = CyFalse;
+
+    apiRetStatus = CyFxProfileSetTimer(rateHz);
+    if (apiRetStatus == CY_U3P_SUCCESS)
+        glProfile.rateHz = rateHz;
+    return apiRetStatus;
+}
+
+/* Builds one dump response, see cyfxprofile.h */
+CyU3PReturnStatus_t CyFxProfileRead(uint16_t chunk, uint8_t *buffer, uint16_t size, uint16_t *length)
+{
+    CyFxProfileSummary_t *summary = (CyFxProfileSummary_t *)buffer;
+    CyFxProfileThread_t *threads = (CyFxProfileThread_t *)(buffer + sizeof(CyFxProfileSummary_t));
+    CyFxProfilePc_t *pcs = (CyFxProfilePc_t *)buffer;
+    uint32_t first, i, count = 0;
+
+    if (chunk == 0)
+    {
+        if (size < sizeof(CyFxProfileSummary_t) + CY_FX_PROFILE_THREADS * sizeof(CyFxProfileThread_t))
+            return CY_U3P_ERROR_BAD_ARGUMENT;
+
+        *summary = glProfile;
+        summary->pcChunks = (CY_FX_PROFILE_PC_SLOTS + CY_FX_PROFILE_PC_PER_CHUNK - 1) / CY_FX_PROFILE_PC_PER_CHUNK;
+        for (i = 0; i < summary->threadCount; i++)
+            threads[i] = glProfileThreads[i].stats;
+        *length = sizeof(CyFxProfileSummary_t) + summary->threadCount * sizeof(CyFxProfileThread_t);
+        return CY_U3P_SUCCESS;
+    }
+
+    first = (chunk - 1) * CY_FX_PROFILE_PC_PER_CHUNK;
+    if ((first >= CY_FX_PROFILE_PC_SLOTS) || (size < CY_FX_PROFILE_PC_PER_CHUNK * sizeof(CyFxProfilePc_t)))
+        return CY_U3P_ERROR_BAD_ARGUMENT;
+
+    for (i = first; (i < first + CY_FX_PROFILE_PC_PER_CHUNK) && (i < CY_FX_PROFILE_PC_SLOTS); i++)
+    {
+        if (glProfilePc[i].count != 0)
+            pcs[count++] = glProfilePc[i];
+    }
+    *length = count * sizeof(CyFxProfilePc_t);
+    return CY_U3P_SUCCESS;
+}
+
+CyU3PReturnStatus_t CyFxProfileInit(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+
+    apiRetStatus = CyU3PEventCreate(&glProfileEvent);
+    if (apiRetStatus != CY_U3P_SUCCESS)
+        return apiRetStatus;
+
+    CyFxThreadMonAdd(&glProfileThread, glProfileStack, CY_FX_PROFILE_THREAD_STACK);
+    return CyU3PThreadCreate(&glProfileThread,   /* Sampler thread structure */
+            "23:Profiler thread",               /* Thread ID and Thread name */
+            CyFxProfileThreadEntry,             /* Sampler thread entry function */
+            0,                                  /* No input parameter to thread */
+            glProfileStack,                     /* Static thread stack */
+            CY_FX_PROFILE_THREAD_STACK,         /* Thread stack size */
+            CY_FX_PROFILE_THREAD_PRIORITY,      /* Thread priority */
+            CY_FX_PROFILE_THREAD_PRIORITY,      /* Pre-emption threshold for the thread */
+            CYU3P_NO_TIME_SLICE,                /* No time slice for the sampler thread */
+            CYU3P_AUTO_START                    /* Start the thread immediately */
+    );
+}
@@ -0,0 +1,70 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXPROFILE_H_
+#define CYFXPROFILE_H_
+
+/*
+ * Sampling CPU profiler. A complex GPIO timer interrupts at the configured
+ * rate and notes the interrupted thread. A sampler thread, above every other
+ * thread, then reads the program counter from the interrupt frame ThreadX
+ * saved on that thread's stack and adds it to the histograms.
+ *
+ * Controlled with the CY_FX_PROFILE_REQUEST vendor request:
+ *   host to device, wValue = rate in Hz, no data  Clear and start, 0 stops
+ *                                                 (the timer keeps running for
+ *                                                 the thread monitor, see
+ *                                                 cyfxthreadmon.h)
+ *   device to host, wValue = 0                    CyFxProfileSummary_t and
+ *                                                 'threadCount' CyFxProfileThread_t
+ *   device to host, wValue = 1..pcChunks          Up to CY_FX_PROFILE_PC_PER_CHUNK
+ *                                                 CyFxProfilePc_t records
+ * Stop the profiler before dumping it to get a consistent snapshot.
+ */
+#define CY_FX_GPIO_PROFILE              (51)      /* Complex GPIO, the pin is not driven */
+#define CY_FX_PROFILE_RATE_MAX          (20000)   /* Hz */
+#define CY_FX_PROFILE_THREADS           (16)      /* Distinct threads tracked */
+#define CY_FX_PROFILE_PC_SLOTS          (256)     /* Distinct program counters tracked, power of 2 */
+#define CY_FX_PROFILE_PC_PER_CHUNK      (63)      /* Records per dump request, fits the stats buffer */
+#define CY_FX_PROFILE_THREAD_NAME       (20)
+
+typedef struct CyFxProfileSummary_t
+{
+    uint32_t samples;               /* Timer ticks handled */
+    uint32_t idle;                  /* Ticks with no thread running */
+    uint32_t missed;                /* Ticks while the previous sample was pending */
+    uint32_t unknownPc;             /* Thread known, no interrupt frame found */
+    uint32_t pcOverflow;            /* Samples dropped because the PC table was full */
+    uint16_t rateHz;                /* 0 when stopped */
+    uint8_t  threadCount;           /* CyFxProfileThread_t records following */
+    uint8_t  pcChunks;              /* PC dump requests, wValue 1..pcChunks */
+} CyFxProfileSummary_t;
+
+typedef struct CyFxProfileThread_t
+{
+    char     name[CY_FX_PROFILE_THREAD_NAME];
+    uint32_t count;
+} CyFxProfileThread_t;
+
+typedef struct CyFxProfilePc_t
+{
+    uint32_t pc;
+    uint32_t count;
+} CyFxProfilePc_t;
+
+extern CyU3PReturnStatus_t CyFxProfileInit(void);
+extern CyU3PReturnStatus_t CyFxProfileStart(uint16_t rateHz);
+extern void CyFxProfileTick(void);
+extern CyU3PReturnStatus_t CyFxProfileRead(uint16_t chunk, uint8_t *buffer, uint16_t size, uint16_t *length);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXPROFILE_H_ */
@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3system.h>
+#include <cyu3error.h>
+#include "cyfxstats.h"
+#include "cyfxmempool.h"
+#include "cyfxtx.h"
+#include "cyfxtimer.h"
+#include "cyfxthreadmon.h"
+#include "cyfxcrc.h"
+#include "cyfxcodec.h"
+
+/* Fills the header and returns the page length, 0 if the records do not fit */
+static uint16_t CyFxStatsPageHeader(uint8_t *buffer, uint16_t size, uint16_t page,
+        uint8_t count, uint16_t recordSize)
+{
+    CyFxStatsHeader_t *header = (CyFxStatsHeader_t *)buffer;
+    uint16_t length = sizeof(CyFxStatsHeader_t) + count * recordSize;
+
+    if (length > size)
+        return 0;
+
+    header->page       = page;
+    header->count      = count;
+    header->recordSize = recordSize;
+    return length;
+}
+
+/* Builds a stats page into the buffer, returns its length or 0 if the page is unknown */
+uint16_t CyFxStatsGetPage(uint16_t page, uint8_t *buffer, uint16_t size)
+{
+    uint16_t length = 0;
+
+    switch (page)
+    {
+    case CY_FX_STATS_PAGE_MEMPOOL:
+        length = CyFxStatsPageHeader(buffer, size, page, CY_FX_MEMPOOL_COUNT, sizeof(CyFxMemPoolStats_t));
+        if (length != 0)
+            CyFxMemPoolGetStats((CyFxMemPoolStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_DMA_ARENA:
+        length = CyFxStatsPageHeader(buffer, size, page, 1, sizeof(CyFxDmaArenaStats_t));
+        if (length != 0)
+            CyFxDmaArenaGetStats((CyFxDmaArenaStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_MEM_CHECK:
+        length = CyFxStatsPageHeader(buffer, size, page, CY_FX_MEM_CHECK_HEAPS, sizeof(CyFxMemCheckStats_t));
+        if (length != 0)
+            CyFxMemCheckGetStats((CyFxMemCheckStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_MEM_MAP:
+        length = CyFxStatsPageHeader(buffer, size, page, 1, sizeof(CyFxMemMap_t));
+        if (length != 0)
+            CyU3PMemCopy(buffer + sizeof(CyFxStatsHeader_t), (uint8_t *)&glFxMemMap, sizeof(CyFxMemMap_t));
+        break;
+    case CY_FX_STATS_PAGE_CB_TIME:
+        length = CyFxStatsPageHeader(buffer, size, page, CY_FX_CB_TIME_COUNT, sizeof(CyFxCbTimeStats_t));
+        if (length != 0)
+            CyFxCbTimeGetStats((CyFxCbTimeStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_TIMELINE:
+        length = CyFxStatsPageHeader(buffer, size, page, CY_FX_BOOT_STAGE_COUNT, sizeof(CyFxTimelineMark_t));
+        if (length != 0)
+            CyFxTimelineGet((CyFxTimelineMark_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_THREADS:
+        /* Check the room for the full table, then fix the header for the threads seen */
+        length = CyFxStatsPageHeader(buffer, size, page, CY_FX_THREAD_MON_RECORDS, sizeof(CyFxThreadStats_t));
+        if (length != 0)
+            length = CyFxStatsPageHeader(buffer, size, page,
+                    CyFxThreadMonGetStats((CyFxThreadStats_t *)(buffer + sizeof(CyFxStatsHeader_t))),
+                    sizeof(CyFxThreadStats_t));
+        break;
+    case CY_FX_STATS_PAGE_CRC:
+        length = CyFxStatsPageHeader(buffer, size, page, 1, sizeof(CyFxCrcStats_t));
+        if (length != 0)
+            CyFxCrcGetStats((CyFxCrcStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    case CY_FX_STATS_PAGE_CODEC:
+        length = CyFxStatsPageHeader(buffer, size, page, 1, sizeof(CyFxCodecStats_t));
+        if (length != 0)
+            CyFxCodecGetStats((CyFxCodecStats_t *)(buffer + sizeof(CyFxStatsHeader_t)));
+        break;
+    default:
+        break;
+    }
+
+    return length;
+}
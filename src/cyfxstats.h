@@ -0,0 +1,43 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXSTATS_H_
+#define CYFXSTATS_H_
+
+/*
+ * Diagnostic pages, read by the host with the CY_FX_STATS_REQUEST vendor
+ * request (device to host, wValue = page). Every page starts with a
+ * CyFxStatsHeader_t followed by 'count' records of the page type.
+ */
+#define CY_FX_STATS_PAGE_MEMPOOL        (0)       /* CyFxMemPoolStats_t records */
+#define CY_FX_STATS_PAGE_DMA_ARENA      (1)       /* One CyFxDmaArenaStats_t record */
+#define CY_FX_STATS_PAGE_MEM_CHECK      (2)       /* CyFxMemCheckStats_t records, driver heap first */
+#define CY_FX_STATS_PAGE_MEM_MAP        (3)       /* One CyFxMemMap_t record */
+#define CY_FX_STATS_PAGE_CB_TIME        (4)       /* CyFxCbTimeStats_t records, see cyfxtimer.h */
+#define CY_FX_STATS_PAGE_TIMELINE       (5)       /* CyFxTimelineMark_t records, one per boot stage */
+#define CY_FX_STATS_PAGE_THREADS        (6)       /* CyFxThreadStats_t records, idle row last */
+#define CY_FX_STATS_PAGE_CRC            (7)       /* One CyFxCrcStats_t record, see cyfxcrc.h */
+#define CY_FX_STATS_PAGE_CODEC          (8)       /* One CyFxCodecStats_t record, see cyfxcodec.h */
+
+#define CY_FX_STATS_BUFFER_SIZE         (512)
+
+typedef struct CyFxStatsHeader_t
+{
+    uint8_t  page;                  /* Page number */
+    uint8_t  count;                 /* Records following the header */
+    uint16_t recordSize;            /* Bytes per record */
+} CyFxStatsHeader_t;
+
+extern uint16_t CyFxStatsGetPage(uint16_t page, uint8_t *buffer, uint16_t size);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXSTATS_H_ */
@@ -0,0 +1,30 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3system.h>
+#include "cyfxtcm.h"
+
+#if CY_FX_TCM_ENABLE && CY_FX_DTCM_ENABLE
+/* Defined by cyfx_tcm.ld */
+extern uint32_t _fx_dtcm_start;
+extern uint32_t _fx_dtcm_end;
+
+/* The D-TCM section is not loaded from the image and the startup code only
+ * clears the system RAM BSS, so clear it here */
+void CyFxDtcmInit(void)
+{
+    uint32_t *word;
+
+    for (word = &_fx_dtcm_start; word < &_fx_dtcm_end; word++)
+        *word = 0;
+}
+#else
+void CyFxDtcmInit(void)
+{
+}
+#endif
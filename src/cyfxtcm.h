@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXTCM_H_
+#define CYFXTCM_H_
+
+/*
+ * Tightly coupled memory placement for hot paths.
+ *
+ * CY_FX_ITCM_CODE puts a function into the I-TCM (16 KB at 0x00000000) next
+ * to the SDK's own interrupt code. The SDK linker script fx3.ld already
+ * collects the CYU3P_ITCM_SECTION input section there, so this needs no
+ * linker changes. Calls between the I-TCM and the system RAM are out of BL
+ * range and go through long branch veneers added by the linker.
+ *
+ * CY_FX_DTCM_DATA puts zero-initialized, CPU-only data into the upper half
+ * of the D-TCM (see cyfx_tcm.ld, which must then be the link script). The
+ * DMA engine cannot reach the TCMs, so DMA buffers and anything passed to
+ * CyU3PUsbSendEP0Data or CyU3PUsbGetEP0Data must stay in system RAM.
+ *
+ * Build with -DCY_FX_TCM_ENABLE=0 to get the system RAM placement back, for
+ * example to compare callback timings (stats page CY_FX_STATS_PAGE_CB_TIME).
+ */
+#ifndef CY_FX_TCM_ENABLE
+#define CY_FX_TCM_ENABLE                (1)
+#endif
+
+#ifndef CY_FX_DTCM_ENABLE
+#define CY_FX_DTCM_ENABLE               (0)       /* Needs the cyfx_tcm.ld link script */
+#endif
+
+#if CY_FX_TCM_ENABLE
+#define CY_FX_ITCM_CODE                 __attribute__ ((section ("CYU3P_ITCM_SECTION")))
+#else
+#define CY_FX_ITCM_CODE
+#endif
+
+#if CY_FX_TCM_ENABLE && CY_FX_DTCM_ENABLE
+#define CY_FX_DTCM_DATA                 __attribute__ ((section (".fx_dtcm_bss")))
+#else
+#define CY_FX_DTCM_DATA
+#endif
+
+/* Clears the D-TCM data, must run before the kernel starts */
+extern void CyFxDtcmInit(void);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXTCM_H_ */
@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include "cyfxthreadmon.h"
+
+typedef struct CyFxThreadMonSlot_t
+{
+    CyU3PThread *thread;
+    uint8_t *stack;                 /* Painted stack, NULL for SDK threads */
+    uint32_t stackSize;
+    uint32_t runTimeUs;
+} CyFxThreadMonSlot_t;
+
+CyFxThreadMonSlot_t glThreadMon[CY_FX_THREAD_MON_SLOTS];
+uint8_t glThreadMonCount = 0;
+uint32_t glThreadMonIdleUs = 0;
+
+/* Finds or adds the slot of a thread, NULL when the table is full. The
+ * table only grows, so readers may walk it without a lock. */
+static CyFxThreadMonSlot_t *CyFxThreadMonSlot(CyU3PThread *thread)
+{
+    CyFxThreadMonSlot_t *slot;
+    uint32_t intMask;
+    uint8_t i;
+
+    for (i = 0; i < glThreadMonCount; i++)
+    {
+        if (glThreadMon[i].thread == thread)
+            return &glThreadMon[i];
+    }
+
+    /* Search again: the tick interrupt may have added it meanwhile */
+    slot = NULL;
+    intMask = CyU3PVicDisableAllInterrupts();
+    for (i = 0; i < glThreadMonCount; i++)
+    {
+        if (glThreadMon[i].thread == thread)
+            slot = &glThreadMon[i];
+    }
+    if ((slot == NULL) && (glThreadMonCount < CY_FX_THREAD_MON_SLOTS))
+    {
+        slot = &glThreadMon[glThreadMonCount];
+        slot->thread = thread;
+        glThreadMonCount++;
+    }
+    CyU3PVicEnableInterrupts(intMask);
+    return slot;
+}
+
+/* Paints the stack and registers the thread, call before CyU3PThreadCreate */
+void CyFxThreadMonAdd(CyU3PThread *thread, void *stack, uint32_t stackSize)
+{
+    CyFxThreadMonSlot_t *slot;
+
+    CyU3PMemSet((uint8_t *)stack, CY_FX_THREAD_STACK_FILL, stackSize);
+    slot = CyFxThreadMonSlot(thread);
+    if (slot != NULL)
+    {
+        slot->stackSize = stackSize;
+        slot->stack     = (uint8_t *)stack;
+    }
+}
+
+/* Profiler timer interrupt context */
+void CyFxThreadMonTick(uint32_t periodUs)
+{
+    CyU3PThread *thread = CyU3PThreadIdentify();
+    CyFxThreadMonSlot_t *slot;
+
+    if (thread == NULL)
+    {
+        glThreadMonIdleUs += periodUs;
+        return;
+    }
+
+    slot = CyFxThreadMonSlot(thread);
+    if (slot != NULL)
+        slot->runTimeUs += periodUs;
+}
+
+/* Stacks grow down, so the untouched fill is at the low end */
+static uint32_t CyFxThreadMonStackUsed(const uint8_t *stack, uint32_t stackSize)
+{
+    uint32_t free = 0;
+
+    while ((free < stackSize) && (stack[free] == CY_FX_THREAD_STACK_FILL))
+        free++;
+    return stackSize - free;
+}
+
+/* Fills up to CY_FX_THREAD_MON_RECORDS records, returns the count */
+uint8_t CyFxThreadMonGetStats(CyFxThreadStats_t *stats)
+{
+    uint8_t count = glThreadMonCount;
+    uint8_t i, j;
+
+    for (i = 0; i < count; i++)
+    {
+        CyFxThreadMonSlot_t *slot = &glThreadMon[i];
+        const char *name = slot->thread->tx_thread_name;
+
+        CyU3PMemSet((uint8_t *)&stats[i], 0, sizeof(CyFxThreadStats_t));
+        for (j = 0; (j < CY_FX_THREAD_MON_NAME - 1) && (name != NULL) && name[j]; j++)
+            stats[i].name[j] = name[j];
+        stats[i].runTimeUs = slot->runTimeUs;
+        if (slot->stack != NULL)
+        {
+            stats[i].stackSize = slot->stackSize;
+            stats[i].stackUsed = CyFxThreadMonStackUsed(slot->stack, slot->stackSize);
+        }
+    }
+
+    CyU3PMemSet((uint8_t *)&stats[count], 0, sizeof(CyFxThreadStats_t));
+    stats[count].runTimeUs = glThreadMonIdleUs;
+    return count + 1;
+}
@@ -0,0 +1,50 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXTHREADMON_H_
+#define CYFXTHREADMON_H_
+
+/*
+ * Thread monitor: stack high-water marks and CPU load per thread.
+ *
+ * Application thread stacks are painted with CY_FX_THREAD_STACK_FILL before
+ * the thread is created (CyFxThreadMonAdd); the deepest word that was
+ * overwritten gives the stack use. SDK threads are listed too, without
+ * stack figures.
+ *
+ * The load is sampled: every profiler timer tick (cyfxprofile.h, at least
+ * CY_FX_THREAD_MON_RATE Hz) charges its period to the interrupted thread,
+ * or to the idle row. The run times are free running microsecond counters;
+ * the load over an interval is the difference of two reads.
+ */
+#define CY_FX_THREAD_MON_SLOTS          (12)      /* Threads tracked, SDK threads included */
+#define CY_FX_THREAD_MON_RATE           (1000)    /* Hz, tick rate while the profiler is stopped */
+#define CY_FX_THREAD_STACK_FILL         (0xEF)    /* Same pattern as the ThreadX stack fill */
+#define CY_FX_THREAD_MON_NAME           (20)
+
+/* Stats page record, the last record is the idle row with an empty name */
+typedef struct CyFxThreadStats_t
+{
+    char     name[CY_FX_THREAD_MON_NAME];
+    uint32_t runTimeUs;             /* Sampled run time, wraps */
+    uint32_t stackSize;             /* 0 if the stack is not painted */
+    uint32_t stackUsed;             /* High-water mark, bytes */
+} CyFxThreadStats_t;
+
+#define CY_FX_THREAD_MON_RECORDS        (CY_FX_THREAD_MON_SLOTS + 1)
+
+extern void CyFxThreadMonAdd(CyU3PThread *thread, void *stack, uint32_t stackSize);
+extern void CyFxThreadMonTick(uint32_t periodUs);
+extern uint8_t CyFxThreadMonGetStats(CyFxThreadStats_t *stats);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXTHREADMON_H_ */
@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include <cyu3os.h>
+#include <cyu3system.h>
+#include <cyu3error.h>
+#include <cyu3gpio.h>
+#include "cyfxtimer.h"
+#include "cyfxtcm.h"
+
+CyBool_t glTimerRunning = CyFalse;
+uint32_t glTimerLast = 0;               /* Newest sample seen by CyFxTimerExtend */
+uint32_t glTimerWraps = 0;              /* Upper word of the 64-bit count */
+CyFxCbTimeStats_t glCbTime[CY_FX_CB_TIME_COUNT] CY_FX_DTCM_DATA;
+CyFxTimelineMark_t glTimeline[CY_FX_BOOT_STAGE_COUNT];
+
+/* Starts the counter, the GPIO block must be initialized */
+CyU3PReturnStatus_t CyFxTimerInit(void)
+{
+    CyU3PReturnStatus_t apiRetStatus = CY_U3P_SUCCESS;
+    CyU3PGpioComplexConfig_t gpioConfig;
+
+    CyU3PMemSet((uint8_t *)&gpioConfig, 0, sizeof(gpioConfig));
+    gpioConfig.outValue    = CyFalse;
+    gpioConfig.driveLowEn  = CyFalse;
+    gpioConfig.driveHighEn = CyFalse;
+    gpioConfig.inputEn     = CyFalse;
+    gpioConfig.pinMode     = CY_U3P_GPIO_MODE_STATIC;
+    gpioConfig.intrMode    = CY_U3P_GPIO_NO_INTR;
+    gpioConfig.timerMode   = CY_U3P_GPIO_TIMER_HIGH_FREQ;
+    gpioConfig.timer       = 0;
+    gpioConfig.period      = 0xFFFFFFFF;
+    gpioConfig.threshold   = 0xFFFFFFFF;
+    apiRetStatus = CyU3PGpioSetComplexConfig(CY_FX_GPIO_TIMER, &gpioConfig);
+    if (apiRetStatus == CY_U3P_SUCCESS)
+        glTimerRunning = CyTrue;
+
+    return apiRetStatus;
+}
+
+/* Current tick count, 0 until the timer is started */
+CY_FX_ITCM_CODE uint32_t CyFxTimerNow(void)
+{
+    uint32_t ticks = 0;
+
+    if (glTimerRunning)
+        CyU3PGpioComplexSampleNow(CY_FX_GPIO_TIMER, &ticks);
+    return ticks;
+}
+
+/* Widens a sample taken within the last 10 s to 64 bits. Samples may come
+ * in out of order from different contexts, older ones do not move the state. */
+CY_FX_ITCM_CODE uint64_t CyFxTimerExtend(uint32_t ticks)
+{
+    uint32_t intMask;
+    uint32_t wraps;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    if ((int32_t)(ticks - glTimerLast) >= 0)
+    {
+        if (ticks < glTimerLast)
+            glTimerWraps++;
+        glTimerLast = ticks;
+        wraps = glTimerWraps;
+    }
+    else
+        wraps = (ticks > glTimerLast) ? glTimerWraps - 1 : glTimerWraps;
+    CyU3PVicEnableInterrupts(intMask);
+
+    return ((uint64_t)wraps << 32) | ticks;
+}
+
+/* Current 64-bit tick count, see cyfxtimer.h */
+CY_FX_ITCM_CODE uint64_t CyFxTimerNow64(void)
+{
+    return CyFxTimerExtend(CyFxTimerNow());
+}
+
+/* Adds one call of a callback that started at startTicks. Callbacks of one id
+ * must not run concurrently; both USB callbacks run on the USB driver thread. */
+CY_FX_ITCM_CODE void CyFxCbTimeRecord(CyFxCbTimeId_t id, uint32_t startTicks)
+{
+    CyFxCbTimeStats_t *stats = &glCbTime[id];
+    uint32_t ticks;
+
+    if (!glTimerRunning)
+        return;
+
+    ticks = CyFxTimerNow() - startTicks;
+    if ((stats->count == 0) || (ticks < stats->minTicks))
+        stats->minTicks = ticks;
+    if (ticks > stats->maxTicks)
+        stats->maxTicks = ticks;
+    stats->totalTicksLo += ticks;
+    if (stats->totalTicksLo < ticks)
+        stats->totalTicksHi++;
+    stats->count++;
+}
+
+/* Fills CY_FX_CB_TIME_COUNT records */
+void CyFxCbTimeGetStats(CyFxCbTimeStats_t *stats)
+{
+    uint32_t i;
+
+    for (i = 0; i < CY_FX_CB_TIME_COUNT; i++)
+    {
+        stats[i] = glCbTime[i];
+        stats[i].id    = i;
+        stats[i].flags = CY_FX_TCM_ENABLE ? CY_FX_CB_TIME_FLAG_ITCM : 0;
+    }
+}
+
+/* Stamps the first completion of a boot stage, later calls are ignored */
+CY_FX_ITCM_CODE void CyFxTimelineMark(CyFxTimelineStage_t stage)
+{
+    CyFxTimelineMark_t *mark = &glTimeline[stage];
+    uint32_t intMask;
+
+    if (mark->flags & CY_FX_BOOT_FLAG_REACHED)
+        return;
+
+    intMask = CyU3PVicDisableAllInterrupts();
+    if (!(mark->flags & CY_FX_BOOT_FLAG_REACHED))
+    {
+        mark->ticks = CyFxTimerNow();
+        mark->flags = CY_FX_BOOT_FLAG_REACHED | (glTimerRunning ? CY_FX_BOOT_FLAG_TIMED : 0);
+    }
+    CyU3PVicEnableInterrupts(intMask);
+}
+
+/* Fills CY_FX_BOOT_STAGE_COUNT records */
+void CyFxTimelineGet(CyFxTimelineMark_t *marks)
+{
+    uint32_t i;
+
+    for (i = 0; i < CY_FX_BOOT_STAGE_COUNT; i++)
+    {
+        marks[i] = glTimeline[i];
+        marks[i].stage = i;
+    }
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXTIMER_H_
+#define CYFXTIMER_H_
+
+/*
+ * Free running 32-bit cycle counter on a complex GPIO timer, clocked from the
+ * GPIO fast clock (SYS_CLK / 2 = 201.6 MHz, about 5 ns per tick). It wraps
+ * every 21 s, so only differences of close timestamps are meaningful.
+ *
+ * CyFxTimerNow64 extends the counter to 64 bits with a wrap count, for
+ * timestamps the host correlates with its own clock. The extension needs a
+ * sample at least every 10 s; the housekeeping loop takes one.
+ */
+#define CY_FX_GPIO_TIMER                (50)      /* Complex GPIO, the pin is not driven */
+#define CY_FX_TIMER_HZ                  (201600000)
+
+/* Timed callbacks, record order of the CY_FX_STATS_PAGE_CB_TIME page */
+typedef enum CyFxCbTimeId_t
+{
+    CY_FX_CB_TIME_USB_SETUP = 0,    /* CyFxUsbSetupCB */
+    CY_FX_CB_TIME_USB_EVENT,        /* CyFxUsbEventCB */
+    CY_FX_CB_TIME_COUNT
+} CyFxCbTimeId_t;
+
+#define CY_FX_CB_TIME_FLAG_ITCM         (0x0001)  /* The callback runs from the I-TCM */
+
+/* Callback execution time, also the wire format of the stats page */
+typedef struct CyFxCbTimeStats_t
+{
+    uint16_t id;                    /* CyFxCbTimeId_t */
+    uint16_t flags;                 /* CY_FX_CB_TIME_FLAG_* */
+    uint32_t count;                 /* Calls measured */
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint32_t totalTicksLo;          /* Sum of all calls, 64 bits */
+    uint32_t totalTicksHi;
+} CyFxCbTimeStats_t;
+
+/*
+ * Boot timeline, record order of the CY_FX_STATS_PAGE_TIMELINE page. Each
+ * stage is stamped once, when it completes. The counter is started by
+ * CyFxGpioInit, the first step of the application thread, so the stages
+ * before the kernel runs are recorded in order but without a time.
+ */
+typedef enum CyFxTimelineStage_t
+{
+    CY_FX_BOOT_MAIN = 0,            /* main() entered */
+    CY_FX_BOOT_DEVICE_INIT,         /* CyU3PDeviceInit and cache setup done */
+    CY_FX_BOOT_IO_MATRIX,           /* IO matrix configured, kernel entry next */
+    CY_FX_BOOT_GPIO_INIT,           /* CyFxGpioInit done, counter running */
+    CY_FX_BOOT_USB_INIT,            /* CyU3PUsbStart and callbacks registered */
+    CY_FX_BOOT_CONNECT,             /* CyU3PConnectState done */
+    CY_FX_BOOT_DEBUG_INIT,          /* CyFxDebugInit done, after connect */
+    CY_FX_BOOT_FIRST_SETUP,         /* First control request from the host */
+    CY_FX_BOOT_APP_START,           /* Bulk channel ready, first usable transfer */
+    CY_FX_BOOT_STAGE_COUNT
+} CyFxTimelineStage_t;
+
+#define CY_FX_BOOT_FLAG_REACHED         (0x0001)  /* The stage has completed */
+#define CY_FX_BOOT_FLAG_TIMED           (0x0002)  /* ticks is valid */
+
+/* Boot stage stamp, also the wire format of the stats page */
+typedef struct CyFxTimelineMark_t
+{
+    uint16_t stage;                 /* CyFxTimelineStage_t */
+    uint16_t flags;                 /* CY_FX_BOOT_FLAG_* */
+    uint32_t ticks;                 /* Counter value, i.e. ticks since CyFxGpioInit started it */
+} CyFxTimelineMark_t;
+
+/*
+ * Device clock sample, the reply to CY_FX_TIME_REQUEST (device to host). The
+ * ticks are taken on entry to the setup callback; the host pairs them with
+ * the midpoint of its own clock around the control transfer and fits the
+ * drift over many samples.
+ */
+typedef struct CyFxTimeSample_t
+{
+    uint32_t ticksLo;               /* CyFxTimerNow64() */
+    uint32_t ticksHi;
+    uint32_t timerHz;               /* Nominal counter rate, CY_FX_TIMER_HZ */
+} CyFxTimeSample_t;
+
+extern CyU3PReturnStatus_t CyFxTimerInit(void);
+extern uint32_t CyFxTimerNow(void);
+extern uint64_t CyFxTimerExtend(uint32_t ticks);
+extern uint64_t CyFxTimerNow64(void);
+extern void CyFxCbTimeRecord(CyFxCbTimeId_t id, uint32_t startTicks);
+extern void CyFxCbTimeGetStats(CyFxCbTimeStats_t *stats);
+extern void CyFxTimelineMark(CyFxTimelineStage_t stage);
+extern void CyFxTimelineGet(CyFxTimelineMark_t *marks);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXTIMER_H_ */
@@ -37,6 +37,8 @@
 #include <cyu3utils.h>
 #include <cyu3error.h>
 #include <cyfxversion.h>
+#include "cyfxtx.h"
+#include "cyfxmempool.h"
 
 /* Memory error detection is supported in SDK 1.3.3 and later. */
 #if ((CYFX_VERSION_MINOR > 3) || ((CYFX_VERSION_MINOR == 3) && (CYFX_VERSION_PATCH >= 3)))
@@ -71,10 +73,14 @@
 #define CY_U3P_MEM_HEAP_SIZE         (0x7000)
 
 /*
-   The last 32 KB of RAM is reserved for 2-stage boot operation. This value can be
-   changed to 0x40040000 if 2-stage boot is not used by the application.
+   The last 32 KB of RAM is reserved for 2-stage boot operation. The CY_FX_MEM_PROFILE_NO_BOOT_AREA
+   profile merges it into the buffer area.
  */
+#if (CY_FX_MEM_PROFILE == CY_FX_MEM_PROFILE_NO_BOOT_AREA)
+#define CY_U3P_SYS_MEM_TOP           (0x40040000)
+#else
 #define CY_U3P_SYS_MEM_TOP           (0x40038000)
+#endif
 
 #else /* 512 KB RAM is available. */
 
@@ -102,10 +108,14 @@
 #define CY_U3P_MEM_HEAP_SIZE         (0x8000)
 
 /*
-   The last 32 KB of RAM is reserved for 2-stage boot operation. This value can be
-   changed to 0x40080000 if 2-stage boot is not used by the application.
+   The last 32 KB of RAM is reserved for 2-stage boot operation. The CY_FX_MEM_PROFILE_NO_BOOT_AREA
+   profile merges it into the buffer area.
  */
+#if (CY_FX_MEM_PROFILE == CY_FX_MEM_PROFILE_NO_BOOT_AREA)
+#define CY_U3P_SYS_MEM_TOP           (0x40080000)
+#else
 #define CY_U3P_SYS_MEM_TOP           (0x40078000)
+#endif
 
 #endif
 
@@ -118,6 +128,22 @@
 #define CY_U3P_BUFFER_HEAP_BASE         (CY_U3P_MEM_HEAP_BASE + CY_U3P_MEM_HEAP_SIZE)
 #define CY_U3P_BUFFER_HEAP_SIZE         ((CY_U3P_SYS_MEM_TOP) - (CY_U3P_BUFFER_HEAP_BASE))
 
+/*
+   The DMA buffer arena takes whole slots from the top of the buffer heap, leaving at least
+   CY_FX_DMA_ARENA_HEAP_RESERVE bytes to the bitmap allocator. The arena tracks its slots in a
+   32 bit mask, which limits it to 32 slots.
+ */
+#define CY_FX_DMA_ARENA_SLOTS_MAX       (32)
+#define CY_FX_DMA_ARENA_SLOTS_AVAIL     ((CY_U3P_BUFFER_HEAP_SIZE > CY_FX_DMA_ARENA_HEAP_RESERVE) ? \
+        ((CY_U3P_BUFFER_HEAP_SIZE - CY_FX_DMA_ARENA_HEAP_RESERVE) / CY_FX_DMA_ARENA_SLOT_SIZE) : 0)
+#define CY_FX_DMA_ARENA_SLOTS           (CY_U3P_MIN (CY_FX_DMA_ARENA_SLOTS_AVAIL, CY_FX_DMA_ARENA_SLOTS_MAX))
+#define CY_FX_DMA_ARENA_SIZE            (CY_FX_DMA_ARENA_SLOTS * CY_FX_DMA_ARENA_SLOT_SIZE)
+#define CY_FX_DMA_ARENA_BASE            (CY_U3P_SYS_MEM_TOP - CY_FX_DMA_ARENA_SIZE)
+#define CY_FX_DMA_ARENA_NONE            (0xFF)
+
+/* Part of the buffer heap managed by the bitmap allocator. */
+#define CY_U3P_BUFFER_MGR_SIZE          (CY_U3P_BUFFER_HEAP_SIZE - CY_FX_DMA_ARENA_SIZE)
+
 #define CY_U3P_BUFFER_ALLOC_TIMEOUT     (10)
 #define CY_U3P_MEM_ALLOC_TIMEOUT        (10)
 
@@ -135,6 +161,26 @@ static CyBool_t         glMemPoolInit   = CyFalse;              /* Whether the m
 static CyU3PBytePool    glMemBytePool;                          /* ThreadX Byte pool used in the CyU3PMem* functions. */
 static CyU3PDmaBufMgr_t glBufferManager = {{0}, 0, 0, 0, 0, 0}; /* Buffer manager used in the buffer alloc functions. */
 
+/* Memory map of this build, read by the host and by the tools/fx3memreport.py build report. */
+const CyFxMemMap_t glFxMemMap =
+{
+    CY_FX_MEM_PROFILE,
+    CY_U3P_MEM_HEAP_BASE,
+    CY_U3P_MEM_HEAP_SIZE,
+    CY_U3P_BUFFER_HEAP_BASE,
+    CY_U3P_BUFFER_HEAP_SIZE,
+    CY_U3P_SYS_MEM_TOP,
+    CY_FX_DMA_ARENA_BASE,
+    CY_FX_DMA_ARENA_SLOT_SIZE,
+    CY_FX_DMA_ARENA_SLOTS,
+    CY_U3P_BUFFER_MGR_SIZE
+};
+
+static uint8_t          glDmaArenaNext[CY_FX_DMA_ARENA_SLOTS_MAX];      /* Free list links, indexed by slot. */
+static uint8_t          glDmaArenaHead = CY_FX_DMA_ARENA_NONE;          /* First free slot. */
+static uint32_t         glDmaArenaUsed = 0;                             /* One bit per allocated slot. */
+static CyFxDmaArenaStats_t glDmaArenaStats;                             /* Arena usage counters. */
+
 #ifdef CYFXTX_ERRORDETECTION
 
 /*
@@ -157,6 +203,29 @@ static uint32_t         glBufFreeCnt         = 0;               /* Number of fre
 static MemBlockInfo    *glBufInUseList       = 0;               /* List of all memory blocks in use. */
 static CyU3PMemCorruptCallback glBufBadCb    = 0;               /* Callback for notification of corrupted memory. */
 
+/*
+   State of the incremental corruption checker, one per heap. The cursor is the next block
+   to validate; the free functions move it past a block that is being freed, so it stays
+   valid while the in-use lists change between steps.
+ */
+typedef struct CyFxMemCheckState_t
+{
+    MemBlockInfo      **head_p;                                 /* In-use list to walk. */
+    MemBlockInfo       *cursor;                                 /* Next block to validate. */
+    CyBool_t            inPass;                                 /* Whether a walk is in progress. */
+    uint16_t            passBlocks;                             /* Blocks validated in the current walk. */
+    uint32_t            lowAddr;                                /* Valid block address range. */
+    uint32_t            highAddr;
+    CyU3PMemCorruptCallback *badCb_p;                           /* Corruption callback of the heap. */
+} CyFxMemCheckState_t;
+
+static CyFxMemCheckState_t glMemCheck[CY_FX_MEM_CHECK_HEAPS] =
+{
+    { &glMemInUseList, 0, CyFalse, 0, CY_U3P_MEM_HEAP_BASE,    CY_U3P_BUFFER_HEAP_BASE, &glMemBadCb },
+    { &glBufInUseList, 0, CyFalse, 0, CY_U3P_BUFFER_HEAP_BASE, CY_U3P_SYS_MEM_TOP,      &glBufBadCb }
+};
+static CyFxMemCheckStats_t glMemCheckStats[CY_FX_MEM_CHECK_HEAPS];
+
 #endif
 
 /**********************************************************************
@@ -294,6 +363,9 @@ CyU3PMemInit (
  *                firmware application. This function is used by the SDK internal drivers
  *                in addition to the application code itself.
  *                The default implementation makes use of the ThreadX byte pool services.
+ *                Requests that fit a block pool (cyfxmempool.h) are served from it
+ *                once the pools exist; they carry no header and are not covered by
+ *                the leak and corruption checks.
  *                If memory leak and corruption checking is enabled, the implementation
  *                adds a 20 byte header and a 4 byte footer around the memory block.
  * Parameters   :
@@ -309,8 +381,14 @@ CyU3PMemAlloc (
 
 #ifdef CYFXTX_ERRORDETECTION
     MemBlockInfo *block_p;
+    uint32_t      intMask;
 #endif
 
+    /* Small blocks first: O(1) and no fragmentation of the byte pool */
+    ret_p = CyFxMemPoolAlloc (size);
+    if (ret_p != NULL)
+        return ret_p;
+
     /* Round size up to a multiple of 4 bytes. */
     size = ROUND_UP (size, 4);
 
@@ -339,16 +417,20 @@ CyU3PMemAlloc (
             block_p = (MemBlockInfo *)ret_p;
             block_p->alloc_id        = glMemAllocCnt++;
             block_p->alloc_size      = size;
-            block_p->prev_blk        = glMemInUseList;
             block_p->next_blk        = 0;
             block_p->start_sig       = CY_U3P_MEM_START_SIG;
-            if (glMemInUseList != 0)
-                glMemInUseList->next_blk = block_p;
-            glMemInUseList           = block_p;
 
             /* Add the end block signature as a footer. */
             ((uint32_t *)block_p)[BYTE_TO_DWORD (size) - 1] = CY_U3P_MEM_END_SIG;
 
+            /* The list is shared with other threads and the corruption checker. */
+            intMask = CyU3PVicDisableAllInterrupts ();
+            block_p->prev_blk        = glMemInUseList;
+            if (glMemInUseList != 0)
+                glMemInUseList->next_blk = block_p;
+            glMemInUseList           = block_p;
+            CyU3PVicEnableInterrupts (intMask);
+
             /* Update the return pointer to skip the header created. */
             ret_p = (void *)((uint8_t *)block_p + sizeof (MemBlockInfo));
         }
@@ -372,12 +454,16 @@ CyU3PMemFree (
 #ifdef CYFXTX_ERRORDETECTION
     MemBlockInfo *block_p;
     uint32_t     *endsig_p;
+    uint32_t      intMask;
 #endif
 
     /* Validity check for the pointer. */
     if ((uint32_t)mem_p < CY_U3P_MEM_HEAP_BASE)
         return;
 
+    if (CyFxMemPoolFree (mem_p))
+        return;
+
 #ifdef CYFXTX_ERRORDETECTION
     /* If memory checks are enabled, ensure that the block is valid; and perform
        the required book-keeping as well. */
@@ -396,6 +482,7 @@ CyU3PMemFree (
         glMemFreeCnt++;
 
         /* Update the in-use linked list to drop the freed-up block. */
+        intMask = CyU3PVicDisableAllInterrupts ();
         if (block_p->next_blk != 0)
             block_p->next_blk->prev_blk = block_p->prev_blk;
         if (block_p->prev_blk != 0)
@@ -404,6 +491,11 @@ CyU3PMemFree (
         {
             glMemInUseList = block_p->prev_blk;
         }
+        if (glMemCheck[0].cursor == block_p)
+        {
+            glMemCheck[0].cursor = block_p->prev_blk;
+        }
+        CyU3PVicEnableInterrupts (intMask);
 
         mem_p = (void *)block_p;
     }
@@ -685,6 +777,122 @@ CyU3PBufEnableChecks (
 
 #endif
 
+/* Function    : CyFxDmaArenaInit
+ * Description : Links all arena slots into the free list. Called from CyU3PDmaBufferInit
+ *               before any thread is running.
+ * Parameters  : None
+ */
+static void
+CyFxDmaArenaInit (
+        void)
+{
+    uint8_t slot;
+
+    glDmaArenaHead = (CY_FX_DMA_ARENA_SLOTS != 0) ? 0 : CY_FX_DMA_ARENA_NONE;
+    for (slot = 0; slot < CY_FX_DMA_ARENA_SLOTS; slot++)
+    {
+        glDmaArenaNext[slot] = ((slot + 1) < CY_FX_DMA_ARENA_SLOTS) ? (slot + 1) : CY_FX_DMA_ARENA_NONE;
+    }
+    glDmaArenaUsed = 0;
+
+    CyU3PMemSet ((uint8_t *)&glDmaArenaStats, 0, sizeof (glDmaArenaStats));
+    glDmaArenaStats.baseAddr  = CY_FX_DMA_ARENA_BASE;
+    glDmaArenaStats.slotSize  = CY_FX_DMA_ARENA_SLOT_SIZE;
+    glDmaArenaStats.slotCount = CY_FX_DMA_ARENA_SLOTS;
+}
+
+/* Function     : CyFxDmaArenaAlloc
+ * Description  : Takes a slot from the arena free list in constant time. Interrupts are
+ *                disabled only around the list update, so this is safe from any context.
+ * Parameters   :
+ *                size : Size of memory required in bytes.
+ * Return Value : Pointer to the slot, or 0 if the request is not for the arena or the
+ *                arena is exhausted.
+ */
+static void *
+CyFxDmaArenaAlloc (
+        uint16_t size)
+{
+    uint32_t intMask;
+    uint8_t  slot;
+
+    if ((glDmaArenaStats.slotCount == 0) || (size < CY_FX_DMA_ARENA_MIN_REQUEST) ||
+            (size > CY_FX_DMA_ARENA_SLOT_SIZE))
+        return 0;
+
+    intMask = CyU3PVicDisableAllInterrupts ();
+    slot = glDmaArenaHead;
+    if (slot == CY_FX_DMA_ARENA_NONE)
+    {
+        glDmaArenaStats.fallbackCount++;
+        CyU3PVicEnableInterrupts (intMask);
+        return 0;
+    }
+
+    glDmaArenaHead  = glDmaArenaNext[slot];
+    glDmaArenaUsed |= (1U << slot);
+    glDmaArenaStats.allocCount++;
+    if (++glDmaArenaStats.inUse > glDmaArenaStats.peak)
+        glDmaArenaStats.peak = glDmaArenaStats.inUse;
+    CyU3PVicEnableInterrupts (intMask);
+
+    return (void *)(CY_FX_DMA_ARENA_BASE + slot * CY_FX_DMA_ARENA_SLOT_SIZE);
+}
+
+/* Function     : CyFxDmaArenaFree
+ * Description  : Returns a slot to the arena free list.
+ * Parameters   :
+ *                buffer : Pointer to the memory block to be freed.
+ * Return Value : CyTrue if the block belongs to the arena (a pointer that is not the
+ *                start of a slot, or a slot that is not allocated, is ignored), CyFalse
+ *                if it has to be freed by the bitmap allocator.
+ */
+static CyBool_t
+CyFxDmaArenaFree (
+        void *buffer)
+{
+    uint32_t addr = (uint32_t)buffer;
+    uint32_t intMask;
+    uint8_t  slot;
+
+    if ((glDmaArenaStats.slotCount == 0) || (addr < CY_FX_DMA_ARENA_BASE) || (addr >= CY_U3P_SYS_MEM_TOP))
+        return CyFalse;
+
+    /* Inside the arena but not a block it handed out: freeing the slot it
+       points into would release a buffer still in use */
+    if (((addr - CY_FX_DMA_ARENA_BASE) % CY_FX_DMA_ARENA_SLOT_SIZE) != 0)
+        return CyTrue;
+
+    slot = (addr - CY_FX_DMA_ARENA_BASE) / CY_FX_DMA_ARENA_SLOT_SIZE;
+
+    intMask = CyU3PVicDisableAllInterrupts ();
+    if (glDmaArenaUsed & (1U << slot))
+    {
+        glDmaArenaUsed      &= ~(1U << slot);
+        glDmaArenaNext[slot] = glDmaArenaHead;
+        glDmaArenaHead       = slot;
+        glDmaArenaStats.inUse--;
+    }
+    CyU3PVicEnableInterrupts (intMask);
+
+    return CyTrue;
+}
+
+/* Function     : CyFxDmaArenaGetStats
+ * Description  : Get a snapshot of the DMA buffer arena usage counters.
+ * Parameters   :
+ *                stats : Structure to be filled with the counters.
+ * Return Value : None
+ */
+void
+CyFxDmaArenaGetStats (
+        CyFxDmaArenaStats_t *stats)
+{
+    uint32_t intMask = CyU3PVicDisableAllInterrupts ();
+    CyU3PMemCopy ((uint8_t *)stats, (uint8_t *)&glDmaArenaStats, sizeof (glDmaArenaStats));
+    CyU3PVicEnableInterrupts (intMask);
+}
+
 /* Function    : CyU3PDmaBufferInit
  * Description : This function initializes the custom heap used for DMA buffer allocation.
  *               These functions use a home-grown allocator in order to ensure that all
@@ -720,7 +928,7 @@ CyU3PDmaBufferInit (
        We need one bit per cache line of memory buffer space. Since a DWORD
        array is being used for the status, round up to the necessary number of
        DWORDs. */
-    size = ROUND_UP ((CY_U3P_BUFFER_HEAP_SIZE / FX3_CACHE_LINE_SZ), 32) / 32;
+    size = ROUND_UP ((CY_U3P_BUFFER_MGR_SIZE / FX3_CACHE_LINE_SZ), 32) / 32;
     glBufferManager.usedStatus = (uint32_t *)CyU3PMemAlloc (size * sizeof (uint32_t));
     if (glBufferManager.usedStatus == 0)
     {
@@ -731,17 +939,19 @@ CyU3PDmaBufferInit (
     /* Initially mark all memory as available. If there are any status bits
        beyond the valid memory range, mark these as unavailable. */
     CyU3PMemSet ((uint8_t *)glBufferManager.usedStatus, 0, (size * sizeof (uint32_t)));
-    if (((CY_U3P_BUFFER_HEAP_SIZE / FX3_CACHE_LINE_SZ) & 31) != 0)
+    if (((CY_U3P_BUFFER_MGR_SIZE / FX3_CACHE_LINE_SZ) & 31) != 0)
     {
-        tmp = 32 - ((CY_U3P_BUFFER_HEAP_SIZE / FX3_CACHE_LINE_SZ) & 31);
+        tmp = 32 - ((CY_U3P_BUFFER_MGR_SIZE / FX3_CACHE_LINE_SZ) & 31);
         glBufferManager.usedStatus[size - 1] = ~((1 << tmp) - 1);
     }
 
     /* Initialize the start address and region size variables. */
     glBufferManager.startAddr  = CY_U3P_BUFFER_HEAP_BASE;
-    glBufferManager.regionSize = CY_U3P_BUFFER_HEAP_SIZE;
+    glBufferManager.regionSize = CY_U3P_BUFFER_MGR_SIZE;
     glBufferManager.statusSize = size;
     glBufferManager.searchPos  = 0;
+
+    CyFxDmaArenaInit ();
 }
 
 /* Function    : CyU3PDmaBufferDeInit
@@ -772,6 +982,7 @@ CyU3PDmaBufferDeInit (
     }
 
     /* Free memory and zero out variables. */
+    glDmaArenaStats.slotCount = 0;
     CyU3PMemFree (glBufferManager.usedStatus);
     glBufferManager.usedStatus = 0;
     glBufferManager.startAddr  = 0;
@@ -855,6 +1066,7 @@ CyU3PDmaBufferAlloc (
 {
 #ifdef CYFXTX_ERRORDETECTION
     MemBlockInfo *block_p;
+    uint32_t      intMask;
 #endif
 
     uint32_t tmp;
@@ -863,6 +1075,13 @@ CyU3PDmaBufferAlloc (
     uint32_t blk_size = (uint32_t)size;
     void *ptr = 0;
 
+    /* Stream sized buffers come from the arena without touching the bitmap. */
+    ptr = CyFxDmaArenaAlloc (size);
+    if (ptr != 0)
+    {
+        return ptr;
+    }
+
     /* Get the lock for the buffer manager. */
     if (CyU3PThreadIdentify ())
     {
@@ -956,16 +1175,20 @@ CyU3PDmaBufferAlloc (
             block_p = (MemBlockInfo *)ptr;
             block_p->alloc_id        = glBufAllocCnt++;
             block_p->alloc_size      = blk_size;
-            block_p->prev_blk        = glBufInUseList;
             block_p->next_blk        = 0;
             block_p->start_sig       = CY_U3P_MEM_START_SIG;
-            if (glBufInUseList != 0)
-                glBufInUseList->next_blk = block_p;
-            glBufInUseList           = block_p;
 
             /* Add the end block signature as a footer. */
             ((uint32_t *)block_p)[BYTE_TO_DWORD (blk_size) - 1] = CY_U3P_MEM_END_SIG;
 
+            /* The corruption checker walks the list without the buffer manager lock. */
+            intMask = CyU3PVicDisableAllInterrupts ();
+            block_p->prev_blk        = glBufInUseList;
+            if (glBufInUseList != 0)
+                glBufInUseList->next_blk = block_p;
+            glBufInUseList           = block_p;
+            CyU3PVicEnableInterrupts (intMask);
+
             /* Update the return pointer to skip the header created. */
             ptr = (void *)((uint8_t *)block_p + sizeof (MemBlockInfo));
         }
@@ -989,6 +1212,7 @@ CyU3PDmaBufferFree (
 #ifdef CYFXTX_ERRORDETECTION
     MemBlockInfo *block_p;
     uint32_t     *sig_p;
+    uint32_t      intMask;
 #endif
 
     uint32_t status, start, count;
@@ -999,6 +1223,9 @@ CyU3PDmaBufferFree (
     if ((uint32_t)buffer < CY_U3P_BUFFER_HEAP_BASE)
         return retVal;
 
+    if (CyFxDmaArenaFree (buffer))
+        return 0;
+
     /* Get the lock for the buffer manager. */
     if (CyU3PThreadIdentify ())
     {
@@ -1030,6 +1257,7 @@ CyU3PDmaBufferFree (
         glBufFreeCnt++;
 
         /* Update the in-use linked list to drop the freed-up block. */
+        intMask = CyU3PVicDisableAllInterrupts ();
         if (block_p->next_blk != 0)
             block_p->next_blk->prev_blk = block_p->prev_blk;
         if (block_p->prev_blk != 0)
@@ -1038,6 +1266,11 @@ CyU3PDmaBufferFree (
         {
             glBufInUseList = block_p->prev_blk;
         }
+        if (glMemCheck[1].cursor == block_p)
+        {
+            glMemCheck[1].cursor = block_p->prev_blk;
+        }
+        CyU3PVicEnableInterrupts (intMask);
 
         buffer = (void *)block_p;
     }
@@ -1181,7 +1414,136 @@ CyU3PBufCorruptionCheck (
     return CY_U3P_SUCCESS;
 }
 
+/* Function     : CyFxMemCheckHeap
+ * Description  : Validate up to maxBlocks in-use blocks of one heap, continuing from
+ *                where the previous call stopped. Each block is validated with interrupts
+ *                disabled, so the list cannot change under the checker; the time spent
+ *                with interrupts off is bounded by a single block check.
+ * Parameters   :
+ *                check     : Checker state of the heap.
+ *                stats     : Counters of the heap.
+ *                maxBlocks : Maximum number of blocks to validate.
+ * Return Value : CY_U3P_SUCCESS or CY_U3P_ERROR_FAILURE if corruption is found.
+ */
+static CyU3PReturnStatus_t
+CyFxMemCheckHeap (
+        CyFxMemCheckState_t *check,
+        CyFxMemCheckStats_t *stats,
+        uint32_t             maxBlocks)
+{
+    MemBlockInfo *block_p;
+    uint32_t     *mem_p;
+    uint32_t      intMask;
+    uint32_t      count = 0;
+    CyBool_t      isBad;
+
+    while (count < maxBlocks)
+    {
+        intMask = CyU3PVicDisableAllInterrupts ();
+
+        if (!check->inPass)
+        {
+            check->cursor     = *check->head_p;
+            check->inPass     = CyTrue;
+            check->passBlocks = 0;
+        }
+
+        block_p = check->cursor;
+        if (block_p == 0)
+        {
+            /* End of the list, the next call starts a new walk. */
+            check->inPass = CyFalse;
+            stats->passCount++;
+            stats->listLength = check->passBlocks;
+            CyU3PVicEnableInterrupts (intMask);
+            break;
+        }
+
+        isBad = CyTrue;
+        if (((uint32_t)block_p >= check->lowAddr) && ((uint32_t)block_p < check->highAddr) &&
+                (block_p->alloc_size <= (check->highAddr - (uint32_t)block_p)))
+        {
+            mem_p = (uint32_t *)((uint8_t *)block_p + block_p->alloc_size - sizeof (uint32_t));
+            isBad = ((block_p->start_sig != CY_U3P_MEM_START_SIG) || (*mem_p != CY_U3P_MEM_END_SIG));
+        }
+
+        check->cursor = isBad ? 0 : block_p->prev_blk;
+        check->passBlocks++;
+        CyU3PVicEnableInterrupts (intMask);
+
+        count++;
+        if (isBad)
+        {
+            /* The list pointers cannot be trusted any more, start over on the next call. */
+            check->inPass = CyFalse;
+            stats->errorCount++;
+            stats->blockCount += count;
+            if (*check->badCb_p != 0)
+                (*check->badCb_p) ((void *)((uint8_t *)block_p + sizeof (MemBlockInfo)));
+            return CY_U3P_ERROR_FAILURE;
+        }
+    }
+
+    stats->blockCount += count;
+    if (count > stats->maxStepBlocks)
+        stats->maxStepBlocks = count;
+    return CY_U3P_SUCCESS;
+}
+
+#endif
+
+/* Function     : CyFxMemCheckStep
+ * Description  : Run one step of the incremental corruption checker on both the driver
+ *                heap and the buffer heap. Meant to be called periodically from a low
+ *                priority thread; the cost of a step is bounded by maxBlocks per heap.
+ *                Does nothing unless the allocator checks have been enabled.
+ * Parameters   :
+ *                maxBlocks : Maximum number of blocks to validate per heap.
+ * Return Value : CY_U3P_SUCCESS or CY_U3P_ERROR_FAILURE if corruption is found.
+ */
+CyU3PReturnStatus_t
+CyFxMemCheckStep (
+        uint32_t maxBlocks)
+{
+    CyU3PReturnStatus_t stat = CY_U3P_SUCCESS;
+
+#ifdef CYFXTX_ERRORDETECTION
+    if (glMemEnableChecks)
+    {
+        glMemCheckStats[0].stepCount++;
+        if (CyFxMemCheckHeap (&glMemCheck[0], &glMemCheckStats[0], maxBlocks) != CY_U3P_SUCCESS)
+            stat = CY_U3P_ERROR_FAILURE;
+    }
+
+    if (glBufMgrEnableChecks)
+    {
+        glMemCheckStats[1].stepCount++;
+        if (CyFxMemCheckHeap (&glMemCheck[1], &glMemCheckStats[1], maxBlocks) != CY_U3P_SUCCESS)
+            stat = CY_U3P_ERROR_FAILURE;
+    }
+#else
+    (void) maxBlocks;
+#endif
+
+    return stat;
+}
+
+/* Function     : CyFxMemCheckGetStats
+ * Description  : Get the incremental checker counters, driver heap first.
+ * Parameters   :
+ *                stats : Array of CY_FX_MEM_CHECK_HEAPS structures to be filled.
+ * Return Value : None
+ */
+void
+CyFxMemCheckGetStats (
+        CyFxMemCheckStats_t *stats)
+{
+#ifdef CYFXTX_ERRORDETECTION
+    CyU3PMemCopy ((uint8_t *)stats, (uint8_t *)glMemCheckStats, sizeof (glMemCheckStats));
+#else
+    CyU3PMemSet ((uint8_t *)stats, 0, CY_FX_MEM_CHECK_HEAPS * sizeof (CyFxMemCheckStats_t));
 #endif
+}
 
 /*[]*/
 
@@ -0,0 +1,99 @@
+/****************************************************************************
+**
+** This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+** Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+** License: GNU GPL v2, see file LICENSE.
+**
+****************************************************************************/
+
+#include "cyu3types.h"
+#include "cyu3externcstart.h"
+
+#ifndef CYFXTX_H_
+#define CYFXTX_H_
+
+#include "cyfxusb.h"
+
+/*
+ * Memory map profiles, selected with -DCY_FX_MEM_PROFILE=<n>:
+ *   CY_FX_MEM_PROFILE_SDK          SDK default, the top 32 KB of RAM are kept for a
+ *                                  2-stage boot loader
+ *   CY_FX_MEM_PROFILE_NO_BOOT_AREA The 2-stage boot area is merged into the buffer heap
+ *                                  (default, this firmware does not use the boot loader)
+ */
+#define CY_FX_MEM_PROFILE_SDK           (0)
+#define CY_FX_MEM_PROFILE_NO_BOOT_AREA  (1)
+
+#ifndef CY_FX_MEM_PROFILE
+#define CY_FX_MEM_PROFILE               (CY_FX_MEM_PROFILE_NO_BOOT_AREA)
+#endif
+
+/* Memory map of the build, also the wire format of the stats page */
+typedef struct CyFxMemMap_t
+{
+    uint32_t profile;               /* CY_FX_MEM_PROFILE_* */
+    uint32_t memHeapBase;           /* Driver heap */
+    uint32_t memHeapSize;
+    uint32_t bufferHeapBase;        /* DMA buffer heap, bitmap part and arena */
+    uint32_t bufferHeapSize;
+    uint32_t sysMemTop;             /* End of the RAM used by the firmware */
+    uint32_t arenaBase;             /* DMA buffer arena */
+    uint32_t arenaSlotSize;
+    uint32_t arenaSlots;            /* Most bulk channel buffers served by the arena */
+    uint32_t bufferMgrSize;         /* Buffer heap left to the bitmap allocator */
+} CyFxMemMap_t;
+
+extern const CyFxMemMap_t glFxMemMap;
+
+/*
+ * DMA buffer arena. The top of the buffer heap is split into fixed slots at
+ * boot, and stream channel buffers are taken from a free list instead of the
+ * bitmap allocator. The slots are reused across resets and reconfigurations,
+ * so they do not fragment the heap. Requests from CY_FX_DMA_ARENA_MIN_REQUEST
+ * up to the slot size go to the arena; everything else, and any request made
+ * while the arena is exhausted, uses the bitmap allocator.
+ */
+#define CY_FX_DMA_ARENA_SLOT_SIZE       (CY_FX_BULK_BUFFER_SIZE)
+#define CY_FX_DMA_ARENA_MIN_REQUEST     (2048)
+#define CY_FX_DMA_ARENA_HEAP_RESERVE    (0x8000)  /* Buffer heap left to the SDK drivers (debug, EP0, ...) */
+
+typedef struct CyFxDmaArenaStats_t
+{
+    uint32_t baseAddr;              /* First slot */
+    uint16_t slotSize;              /* Bytes per slot */
+    uint8_t  slotCount;             /* Slots in the arena, 0 if there is no room for one */
+    uint8_t  inUse;                 /* Slots allocated right now */
+    uint8_t  peak;                  /* Highest inUse since boot */
+    uint8_t  reserved[3];
+    uint32_t allocCount;            /* Requests served by the arena */
+    uint32_t fallbackCount;         /* Requests passed to the bitmap allocator while the arena was full */
+} CyFxDmaArenaStats_t;
+
+extern void CyFxDmaArenaGetStats(CyFxDmaArenaStats_t *stats);
+
+/*
+ * Incremental corruption checker. With CY_FX_MEM_CHECK_ENABLE set, the leak
+ * and corruption checks of both allocators are turned on at boot, and the
+ * housekeeping thread validates CY_FX_MEM_CHECK_BLOCKS in-use blocks of each
+ * heap per pass instead of walking the whole lists at once.
+ */
+#define CY_FX_MEM_CHECK_ENABLE          (1)
+#define CY_FX_MEM_CHECK_BLOCKS          (8)
+#define CY_FX_MEM_CHECK_HEAPS           (2)       /* Driver heap, buffer heap */
+
+typedef struct CyFxMemCheckStats_t
+{
+    uint32_t stepCount;             /* CyFxMemCheckStep calls */
+    uint32_t blockCount;            /* Blocks validated */
+    uint32_t passCount;             /* Complete walks of the in-use list */
+    uint32_t errorCount;            /* Corrupted blocks found */
+    uint16_t maxStepBlocks;         /* Most blocks validated in one step */
+    uint16_t listLength;            /* Blocks seen in the last complete walk */
+} CyFxMemCheckStats_t;
+
+extern CyU3PReturnStatus_t CyFxMemCheckStep(uint32_t maxBlocks);
+extern void CyFxMemCheckGetStats(CyFxMemCheckStats_t *stats);
+
+#include <cyu3externcend.h>
+
+#endif /* CYFXTX_H_ */
@@ -11,15 +11,23 @@
 #include <cyu3usb.h>
 #include "cyfxdebug.h"
 #include "cyfxusb.h"
+#include "cyfxapplication.h"
+#include "cyfxstats.h"
+#include "cyfxtcm.h"
+#include "cyfxtimer.h"
+#include "cyfxlog.h"
+#include "cyfxprofile.h"
+#include "cyfxlatency.h"
 
 /* Page numbers below reference to "USB 3.2 Revision 1.0.pdf" document */
 
 extern void CyFxFatalErrorHandler(const char* msg, CyU3PReturnStatus_t status, CyBool_t noReturn);
-extern CyU3PReturnStatus_t CyFxUsbAppStart(void);
-extern CyU3PReturnStatus_t CyFxUsbAppStop(void);
+extern volatile CyBool_t glDebugReady;
 
 uint8_t glUsbConfiguration = 0; /* Active USB device configuration */
 uint8_t glEp0Buffer[64] __attribute__ ((aligned (32))); /* EP0 buffer */
+uint8_t glStatsBuffer[CY_FX_STATS_BUFFER_SIZE] __attribute__ ((aligned (32))); /* Stats page buffer */
+uint32_t glUsbTraceEarlyCount = 0; /* Traces skipped because the debug output was not up */
 
 void CyFxUsbDebugPrintRequest(uint8_t bDir, uint8_t bType, uint8_t bTarget, uint8_t bRequest,
         uint16_t wValue, uint16_t wIndex, uint16_t wLength)
@@ -62,7 +70,29 @@ void CyFxUsbDebugPrintRequest(uint8_t bDir, uint8_t bType, uint8_t bTarget, uint
                     bRequest, wValue, wIndex, wLength);
 }
 
-CyU3PReturnStatus_t CyFxUsbSendDescriptor(uint16_t wValue, uint16_t wIndex, uint16_t wLength)
+/* Runs on the worker thread, the setup callback only posts the raw packet */
+void CyFxUsbTraceRequest(uint32_t setupdat0, uint32_t setupdat1, CyBool_t isHandled)
+{
+    uint8_t bReqType = (setupdat0 & CY_U3P_USB_REQUEST_TYPE_MASK);
+
+    CyFxUsbDebugPrintRequest(setupdat0 & USB_REQUEST_DEVICE_TO_HOST,
+            bReqType & CY_U3P_USB_TYPE_MASK,
+            bReqType & CY_U3P_USB_TARGET_MASK,
+            (setupdat0 & CY_U3P_USB_REQUEST_MASK) >> CY_U3P_USB_REQUEST_POS,
+            (setupdat0 & CY_U3P_USB_VALUE_MASK)   >> CY_U3P_USB_VALUE_POS,
+            (setupdat1 & CY_U3P_USB_INDEX_MASK)   >> CY_U3P_USB_INDEX_POS,
+            (setupdat1 & CY_U3P_USB_LENGTH_MASK)  >> CY_U3P_USB_LENGTH_POS);
+
+    if (!isHandled)
+        CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Request is not handled!\r\n");
+}
+
+void CyFxUsbTraceEvent(uint32_t evType, uint32_t evData)
+{
+    CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "USB event  : evType (%d), evData (%d)\r\n", evType, evData);
+}
+
+CY_FX_ITCM_CODE CyU3PReturnStatus_t CyFxUsbSendDescriptor(uint16_t wValue, uint16_t wIndex, uint16_t wLength)
 {
     uint16_t length = 0;
     uint8_t *buffer = NULL;
@@ -144,12 +174,15 @@ CyU3PReturnStatus_t CyFxUsbSendDescriptor(uint16_t wValue, uint16_t wIndex, uint
         return CY_U3P_ERROR_FAILURE;
 }
 
-CyBool_t CyFxUsbSetupCB(uint32_t setupdat0, uint32_t setupdat1)
+CY_FX_ITCM_CODE CyBool_t CyFxUsbSetupCB(uint32_t setupdat0, uint32_t setupdat1)
 {
+    uint32_t startTicks = CyFxTimerNow();
     uint8_t bReqType, bDir, bType, bTarget;
     uint8_t bRequest;
     uint16_t wValue, wIndex, wLength;
     uint16_t br;
+    CyFxStreamStatus_t streamStatus;
+    CyFxTimeSample_t timeSample;
 
     bReqType = (setupdat0 & CY_U3P_USB_REQUEST_TYPE_MASK);
     bDir     = setupdat0 & USB_REQUEST_DEVICE_TO_HOST;  // 0x80 = Device to Host, 0 = Host to Device
@@ -161,9 +194,9 @@ CyBool_t CyFxUsbSetupCB(uint32_t setupdat0, uint32_t setupdat1)
     wLength  = ((setupdat1 & CY_U3P_USB_LENGTH_MASK)  >> CY_U3P_USB_LENGTH_POS);
 
     CyBool_t isHandled = CyFalse;
+    CyBool_t isLogRead = CyFalse;
 
-    if (CY_FX_DEBUG_TRACE_ALL_REQUESTS)
-        CyFxUsbDebugPrintRequest(bDir, bType, bTarget, bRequest, wValue, wIndex, wLength);
+    CyFxTimelineMark(CY_FX_BOOT_FIRST_SETUP);
 
     if ((bType == CY_U3P_USB_STANDARD_RQT)
             && (bTarget == CY_U3P_USB_TARGET_DEVICE)
@@ -246,9 +279,9 @@ CyBool_t CyFxUsbSetupCB(uint32_t setupdat0, uint32_t setupdat1)
             isHandled = CyTrue;
             break;
         case CY_U3P_USB_SC_SET_CONFIGURATION: /* See p.339 */
-            if (wValue == 1) {
+            /* The data path is set up by the worker after the status stage */
+            if ((wValue == 1) && (CyFxAppPost(CY_FX_CMD_APP_START, NULL, 0) == CY_U3P_SUCCESS)) {
                 CyU3PUsbLPMDisable();
-                CyFxUsbAppStart();
                 glUsbConfiguration = wValue;
                 CyU3PUsbAckSetup();
                 isHandled = CyTrue;
@@ -273,29 +306,148 @@ CyBool_t CyFxUsbSetupCB(uint32_t setupdat0, uint32_t setupdat1)
         }
     }
 
-	if (!isHandled)
-    {
-        if (CY_FX_DEBUG_TRACE_ALL_REQUESTS)
-            CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "Request is not handled!\r\n");
+    // Stream configuration request
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bRequest == CY_FX_STREAM_REQUEST)) {
+        if (bDir == USB_REQUEST_DEVICE_TO_HOST) {
+            CyFxStreamGetStatus(&streamStatus);
+            CyU3PMemCopy(glEp0Buffer, (uint8_t *)&streamStatus, sizeof(streamStatus));
+            if (CyU3PUsbSendEP0Data(wLength < sizeof(streamStatus) ? wLength : sizeof(streamStatus),
+                    glEp0Buffer) == CY_U3P_SUCCESS)
+                isHandled = CyTrue;
+        } else if (wLength == sizeof(CyFxStreamConfig_t)) {
+            if ((CyU3PUsbGetEP0Data(sizeof(glEp0Buffer), glEp0Buffer, &br) == CY_U3P_SUCCESS)
+                    && (br == sizeof(CyFxStreamConfig_t))
+                    && (CyFxStreamCheckConfig((CyFxStreamConfig_t *)glEp0Buffer) == CY_U3P_SUCCESS)
+                    && (CyFxAppPost(CY_FX_CMD_STREAM_CONFIG, glEp0Buffer, sizeof(CyFxStreamConfig_t)) == CY_U3P_SUCCESS))
+                isHandled = CyTrue;
+        }
+    }
+
+    // Diagnostic stats page request
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bDir == USB_REQUEST_DEVICE_TO_HOST)
+            && (bRequest == CY_FX_STATS_REQUEST)) {
+        br = CyFxStatsGetPage(wValue, glStatsBuffer, sizeof(glStatsBuffer));
+        if ((br != 0) && (CyU3PUsbSendEP0Data(wLength < br ? wLength : br, glStatsBuffer) == CY_U3P_SUCCESS))
+            isHandled = CyTrue;
+    }
+
+    // Binary log read request, shares the stats buffer
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bDir == USB_REQUEST_DEVICE_TO_HOST)
+            && (bRequest == CY_FX_LOG_REQUEST)) {
+        /* The records leave the ring only once the data phase went out */
+        isLogRead = CyTrue;
+        br = CyFxLogRead(glStatsBuffer, wLength < sizeof(glStatsBuffer) ? wLength : sizeof(glStatsBuffer));
+        if ((br != 0) && (CyU3PUsbSendEP0Data(br, glStatsBuffer) == CY_U3P_SUCCESS)) {
+            CyFxLogCommit();
+            isHandled = CyTrue;
+        }
+    }
+
+    // Sampling profiler control and dump, shares the stats buffer
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bRequest == CY_FX_PROFILE_REQUEST)) {
+        if (bDir == USB_REQUEST_DEVICE_TO_HOST) {
+            if ((CyFxProfileRead(wValue, glStatsBuffer, sizeof(glStatsBuffer), &br) == CY_U3P_SUCCESS)
+                    && (CyU3PUsbSendEP0Data(wLength < br ? wLength : br, glStatsBuffer) == CY_U3P_SUCCESS))
+                isHandled = CyTrue;
+        } else if (wLength == 0) {
+            if (CyFxProfileStart(wValue) == CY_U3P_SUCCESS) {
+                CyU3PUsbAckSetup();
+                isHandled = CyTrue;
+            }
+        }
+    }
+
+    // Latency histograms read and reset, shares the stats buffer
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bRequest == CY_FX_LATENCY_REQUEST)) {
+        if (bDir == USB_REQUEST_DEVICE_TO_HOST) {
+            br = CyFxLatencyGet(glStatsBuffer, sizeof(glStatsBuffer));
+            if ((br != 0) && (CyU3PUsbSendEP0Data(wLength < br ? wLength : br, glStatsBuffer) == CY_U3P_SUCCESS))
+                isHandled = CyTrue;
+        } else if (wLength == 0) {
+            CyFxLatencyReset();
+            CyU3PUsbAckSetup();
+            isHandled = CyTrue;
+        }
+    }
+
+    // Device clock sample, stamped with the callback entry time
+    if ((bType == CY_U3P_USB_VENDOR_RQT)
+            && (bTarget == CY_U3P_USB_TARGET_INTF)
+            && (bDir == USB_REQUEST_DEVICE_TO_HOST)
+            && (bRequest == CY_FX_TIME_REQUEST)) {
+        uint64_t ticks = CyFxTimerExtend(startTicks);
+        timeSample.ticksLo = (uint32_t)ticks;
+        timeSample.ticksHi = (uint32_t)(ticks >> 32);
+        timeSample.timerHz = CY_FX_TIMER_HZ;
+        CyU3PMemCopy(glEp0Buffer, (uint8_t *)&timeSample, sizeof(timeSample));
+        if (CyU3PUsbSendEP0Data(wLength < sizeof(timeSample) ? wLength : sizeof(timeSample),
+                glEp0Buffer) == CY_U3P_SUCCESS)
+            isHandled = CyTrue;
+    }
+
+    if (!isHandled)
         CyU3PUsbStall(0, CyTrue, CyFalse);
+
+    /* The response is out, the rest is bookkeeping */
+    CyFxLatencyRecord(CY_FX_LATENCY_EP0, startTicks);
+
+    /* A drain logging itself would never find the ring empty */
+    if (!isLogRead)
+        CY_FX_LOG3(CY_FX_LOG_USB_SETUP, setupdat0, setupdat1, isHandled);
+
+    /* Connect comes before debug init, see CyFxAppThreadEntry */
+    if (CY_FX_DEBUG_TRACE_ALL_REQUESTS && !glDebugReady)
+        glUsbTraceEarlyCount++;
+    else if (CY_FX_DEBUG_TRACE_ALL_REQUESTS)
+    {
+        uint32_t trace[3] = { setupdat0, setupdat1, isHandled };
+        CyFxAppPost(CY_FX_CMD_TRACE_REQUEST, trace, sizeof(trace));
     }
 
+    CyFxCbTimeRecord(CY_FX_CB_TIME_USB_SETUP, startTicks);
     return isHandled;
 }
 
-void CyFxUsbEventCB (CyU3PUsbEventType_t evType, uint16_t evData)
+CY_FX_ITCM_CODE void CyFxUsbEventCB (CyU3PUsbEventType_t evType, uint16_t evData)
 {
-    if (CY_FX_DEBUG_TRACE_ALL_REQUESTS)
-        CyU3PDebugPrint(CY_FX_DEBUG_PRIORITY, "USB event  : evType (%d), evData (%d)\r\n", evType, evData);
+    uint32_t startTicks = CyFxTimerNow();
+
+    CY_FX_LOG2(CY_FX_LOG_USB_EVENT, evType, evData);
+
+    if (CY_FX_DEBUG_TRACE_ALL_REQUESTS && !glDebugReady)
+        glUsbTraceEarlyCount++;
+    else if (CY_FX_DEBUG_TRACE_ALL_REQUESTS)
+    {
+        uint32_t trace[2] = { evType, evData };
+        CyFxAppPost(CY_FX_CMD_TRACE_EVENT, trace, sizeof(trace));
+    }
 
     switch (evType)
     {
     case CY_U3P_USB_EVENT_RESET:
-        CyFxUsbAppStop();
+        CyFxStreamNotifyReset();
+        CyFxAppPostStop();
+        glUsbConfiguration = 0;
+        break;
+    case CY_U3P_USB_EVENT_DISCONNECT:
+        CyFxAppPostStop();
+        glUsbConfiguration = 0;
         break;
     default:
         break;
     }
+
+    CyFxCbTimeRecord(CY_FX_CB_TIME_USB_EVENT, startTicks);
 }
 
 CyBool_t CyFxUsbLPMRequestCB(CyU3PUsbLinkPowerMode link_mode)
@@ -315,10 +467,12 @@ CyU3PReturnStatus_t CyFxUsbInit(void)
     CyU3PUsbRegisterSetupCallback(CyFxUsbSetupCB, CyFalse);
     CyU3PUsbRegisterEventCallback(CyFxUsbEventCB);
     CyU3PUsbRegisterLPMRequestCallback(CyFxUsbLPMRequestCB);
+    CyFxTimelineMark(CY_FX_BOOT_USB_INIT);
 
     apiRetStatus = CyU3PConnectState(CyTrue, CyTrue);
     if (apiRetStatus != CY_U3P_SUCCESS)
     	CyFxFatalErrorHandler("CyU3PConnectState", apiRetStatus, CyTrue);
+    CyFxTimelineMark(CY_FX_BOOT_CONNECT);
 
     return CY_U3P_SUCCESS;
 }
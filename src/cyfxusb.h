@@ -18,11 +18,29 @@
 #define CY_FX_MS_VENDOR_CODE            (0xAE)    /* Used defined vendor code used by Microsoft WinUSB driver (AE - it's me) */
 #define CY_FX_EP_PRODUCER               (0x01)    /* EP 1 OUT */
 #define CY_FX_EP_CONSUMER               (0x81)    /* EP 1 IN */
+#define CY_FX_EP_EVENT                  (0x82)    /* EP 2 IN, interrupt, see cyfxevent.h */
+#define CY_FX_EVENT_PACKET_SIZE         (16)      /* One CyFxEventRecord_t per packet */
+#define CY_FX_EVENT_INTERVAL            (1)       /* Polled every 2^(n-1) x 125 us */
+#define CY_FX_EVENT_BUFFER_COUNT        (4)
+#define CY_FX_EVENT_STOP_TIMEOUT        (10)      /* ms the host gets to take the STREAM_STOP event */
 #define CY_FX_EP_BURST_LENGTH           (16)
 #define CY_FX_HIGH_SPEED_EP_SIZE        (512)
 #define CY_FX_SUPER_SPEED_EP_SIZE       (1024)
-#define CY_FX_BULK_BUFFER_SIZE          (8192)
+#define CY_FX_BULK_BUFFER_SIZE          (8192)    /* Largest bulk DMA buffer, the DMA arena slot size */
+#define CY_FX_BULK_BUFFER_COUNT_MAX     (32)      /* Also limited by the DMA arena size, see cyfxtx.h */
+
+/* Bulk data path per link speed, the buffer count is the default when the host leaves it 0 */
+#define CY_FX_SS_BULK_BUFFER_SIZE       (8192)    /* 8 packets, half a burst */
+#define CY_FX_SS_BULK_BUFFER_COUNT      (8)
+#define CY_FX_HS_BULK_BUFFER_SIZE       (4096)    /* 8 packets, under the 13 a microframe can carry */
+#define CY_FX_HS_BULK_BUFFER_COUNT      (4)
 #define CY_FX_VENDOR_REQUEST            (0xFF)    /* Vendor request type code */
+#define CY_FX_STREAM_REQUEST            (0xFE)    /* Stream configuration request code */
+#define CY_FX_STATS_REQUEST             (0xFD)    /* Diagnostic stats page request code */
+#define CY_FX_LOG_REQUEST               (0xFC)    /* Binary log read request code, see cyfxlog.h */
+#define CY_FX_PROFILE_REQUEST           (0xFB)    /* Sampling profiler request code, see cyfxprofile.h */
+#define CY_FX_LATENCY_REQUEST           (0xFA)    /* Latency histograms request code, see cyfxlatency.h */
+#define CY_FX_TIME_REQUEST              (0xF9)    /* Device clock sample request code, see cyfxtimer.h */
 
 // A mask to define EP0 request direction
 #define USB_REQUEST_DEVICE_TO_HOST      (0x80)
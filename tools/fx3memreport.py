@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+#
+# This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+# Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+# License: GNU GPL v2, see file LICENSE.
+#
+# Memory budget report for a firmware ELF: code and data against the fx3.ld
+# regions, driver heap, buffer heap and the bulk channel DMA depth. The heap
+# layout is read from the glFxMemMap structure (src/cyfxtx.h), so the report
+# always matches the memory profile the firmware was built with.
+#
+# Usage: fx3memreport.py <firmware.elf>
+# Exits with 1 if code or data do not fit their region.
+
+import struct
+import sys
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+# Regions of the SDK linker script (fx3.ld), selected by the driver heap base
+FX3_LD_REGIONS = {
+    0x40038000: {'code': (0x40003000, 0x40030000), 'data': (0x40030000, 0x40038000)},   # 512 KB RAM
+    0x40029000: {'code': (0x40003000, 0x40023000), 'data': (0x40023000, 0x40029000)},   # 256 KB RAM
+}
+
+MEM_MAP_FIELDS = ('profile', 'memHeapBase', 'memHeapSize', 'bufferHeapBase', 'bufferHeapSize',
+                  'sysMemTop', 'arenaBase', 'arenaSlotSize', 'arenaSlots', 'bufferMgrSize')
+PROFILE_NAMES = {0: 'SDK (2-stage boot area reserved)', 1: 'no boot area'}
+
+SS_BURST_SIZE = 16 * 1024   # CY_FX_EP_BURST_LENGTH x CY_FX_SUPER_SPEED_EP_SIZE
+HS_PACKET_SIZE = 512        # CY_FX_HIGH_SPEED_EP_SIZE
+
+
+class Section:
+    def __init__(self, data, offset):
+        (self.name_off, self.type, self.flags, self.addr, self.offset, self.size,
+         self.link, _, _, self.entsize) = struct.unpack_from('<10I', data, offset)
+        self.name = ''
+
+    def bytes(self, data):
+        return data[self.offset:self.offset + self.size]
+
+
+def c_string(data, offset):
+    return data[offset:data.index(b'\0', offset)].decode('ascii', 'replace')
+
+
+def load_sections(data):
+    if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+        raise ValueError('not a 32-bit little-endian ELF file')
+    shoff, = struct.unpack_from('<I', data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from('<3H', data, 0x2E)
+    sections = [Section(data, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx].bytes(data)
+    for section in sections:
+        section.name = c_string(names, section.name_off)
+    return sections
+
+
+def find_symbol(data, sections, name):
+    for symtab in (s for s in sections if s.type == SHT_SYMTAB):
+        strings = sections[symtab.link].bytes(data)
+        table = symtab.bytes(data)
+        for offset in range(0, len(table), 16):
+            st_name, st_value, st_size, _, _, st_shndx = struct.unpack_from('<IIIBBH', table, offset)
+            if st_name and c_string(strings, st_name) == name and 0 < st_shndx < len(sections):
+                section = sections[st_shndx]
+                start = section.offset + st_value - section.addr
+                return data[start:start + st_size]
+    return None
+
+
+def region_usage(sections, region):
+    low, high = region
+    used = {'code': 0, 'rodata': 0, 'data': 0, 'bss': 0}
+    for section in sections:
+        if not (section.flags & SHF_ALLOC) or not (low <= section.addr < high):
+            continue
+        if section.type == SHT_NOBITS:
+            used['bss'] += section.size
+        elif section.flags & SHF_EXECINSTR:
+            used['code'] += section.size
+        elif section.flags & SHF_WRITE:
+            used['data'] += section.size
+        else:
+            used['rodata'] += section.size
+    return used
+
+
+def kb(value):
+    return '%7.1f KB' % (value / 1024.0)
+
+
+def main(argv):
+    if len(argv) != 2:
+        print('Usage: fx3memreport.py <firmware.elf>')
+        return 2
+
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+    sections = load_sections(data)
+
+    raw = find_symbol(data, sections, 'glFxMemMap')
+    if raw is None or len(raw) < 4 * len(MEM_MAP_FIELDS):
+        print('glFxMemMap not found in %s' % argv[1])
+        return 2
+    mem = dict(zip(MEM_MAP_FIELDS, struct.unpack_from('<%dI' % len(MEM_MAP_FIELDS), raw)))
+
+    print('Memory profile : %d, %s' % (mem['profile'], PROFILE_NAMES.get(mem['profile'], 'unknown')))
+
+    fits = True
+    regions = FX3_LD_REGIONS.get(mem['memHeapBase'])
+    if regions is None:
+        print('Unknown fx3.ld layout, code and data are not checked')
+    else:
+        for name, region in sorted(regions.items()):
+            used = region_usage(sections, region)
+            total = sum(used.values())
+            size = region[1] - region[0]
+            print('%-14s : %s of %s (%3d%%)  %s' % (
+                name.capitalize() + ' area', kb(total), kb(size), total * 100 // size,
+                ', '.join('%s %d' % (k, v) for k, v in sorted(used.items()) if v)))
+            fits = fits and (total <= size)
+
+    print('Driver heap    : %s at 0x%08X' % (kb(mem['memHeapSize']), mem['memHeapBase']))
+    print('Buffer heap    : %s at 0x%08X, bitmap allocator %s' % (
+        kb(mem['bufferHeapSize']), mem['bufferHeapBase'], kb(mem['bufferMgrSize'])))
+
+    if mem['arenaSlots']:
+        buffers = mem['arenaSlots']
+        print('DMA arena      : %d x %d bytes at 0x%08X' % (buffers, mem['arenaSlotSize'], mem['arenaBase']))
+    else:
+        buffers = mem['bufferMgrSize'] // mem['arenaSlotSize']
+        print('DMA arena      : none, bulk buffers come from the bitmap allocator')
+
+    depth = buffers * mem['arenaSlotSize']
+    print('Bulk channel   : up to %d buffers, %s in flight = %d SuperSpeed bursts, %d HighSpeed packets' % (
+        buffers, kb(depth).strip(), depth // SS_BURST_SIZE, depth // HS_PACKET_SIZE))
+
+    if not fits:
+        print('Memory budget exceeded!')
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+#
+# This file is part of the CYPRESS-FX3-WINUSB-BLANK project.
+# Copyright (C) 2025 Alexander E. <aekhv@vk.com>
+# License: GNU GPL v2, see file LICENSE.
+#
+# Symbolizes a firmware profile written by 'fx3-bench profile': maps every
+# sampled program counter to the function that contains it, using the
+# symbol table of the firmware ELF, and prints the functions by samples.
+#
+# Usage: fx3profile.py <firmware.elf> <profile.txt> [top]
+
+import bisect
+import struct
+import sys
+
+from fx3memreport import SHT_SYMTAB, c_string, load_sections
+
+STT_FUNC = 2
+
+
+def load_functions(data, sections):
+    functions = {}
+    for symtab in (s for s in sections if s.type == SHT_SYMTAB):
+        strings = sections[symtab.link].bytes(data)
+        table = symtab.bytes(data)
+        for offset in range(0, len(table), 16):
+            st_name, st_value, st_size, st_info, _, st_shndx = struct.unpack_from('<IIIBBH', table, offset)
+            if st_name and (st_info & 0xF) == STT_FUNC and st_shndx:
+                # Thumb functions have bit 0 set
+                functions[st_value & ~1] = (c_string(strings, st_name), st_size)
+    starts = sorted(functions)
+    return starts, [functions[start] for start in starts]
+
+
+def symbolize(starts, functions, pc):
+    index = bisect.bisect_right(starts, pc) - 1
+    if index < 0:
+        return None
+    name, size = functions[index]
+    # Symbols without a size extend to the next symbol
+    if size and pc >= starts[index] + size:
+        return None
+    return name
+
+
+def main(argv):
+    if len(argv) not in (3, 4):
+        print('Usage: fx3profile.py <firmware.elf> <profile.txt> [top]')
+        return 2
+
+    with open(argv[1], 'rb') as f:
+        data = f.read()
+    starts, functions = load_functions(data, load_sections(data))
+    top = int(argv[3]) if len(argv) == 4 else 30
+
+    counts = {}
+    total = 0
+    with open(argv[2]) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) != 2:
+                continue
+            pc, count = int(fields[0], 0), int(fields[1])
+            name = symbolize(starts, functions, pc) or '0x%08X' % pc
+            counts[name] = counts.get(name, 0) + count
+            total += count
+
+    if not total:
+        print('No samples')
+        return 1
+
+    print('%8s %7s  %s' % ('samples', '%', 'function'))
+    for name, count in sorted(counts.items(), key=lambda item: -item[1])[:top]:
+        print('%8d %6.1f%%  %s' % (count, count * 100.0 / total, name))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))